@@ -0,0 +1,8 @@
+#include "Block.h"
+
+namespace tapioca {
+
+const double Block::fallingSpeed = 3.0;
+const double Block::size = 50.0;
+
+}
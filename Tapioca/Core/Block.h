@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace tapioca {
+
+// Constants and fall arithmetic shared by all blocks. The per-block state
+// lives in BlockField's arrays.
+class Block {
+public:
+    static const double fallingSpeed;
+    static const double size;
+    static constexpr std::uint64_t neverLands = std::numeric_limits<std::uint64_t>::max();
+
+    // Bits of BlockField's per-block flags.
+    enum Flag : std::uint8_t {
+        Moving = 1 << 0,
+        Destroyed = 1 << 1,
+        // Settled blocks are asleep: stepped mode skips them in its update
+        // loop until a block beneath them is destroyed.
+        Asleep = 1 << 2
+    };
+
+    // Where a block falling from y comes to rest when limit is the top of
+    // the block below it or the floor.
+    static double getRestingY(double y, double limit) {
+        return y + fallingSpeed * static_cast<double>(movesUntilBlocked(y, limit));
+    }
+
+    // Stepped mode: whether a block at y stops instead of moving down by
+    // speed, onto floorY or onto block below, an index into ys or -1. Anywhere
+    // on the way down counts, not only the next position, so that no falling
+    // speed can carry a block through the one below it. In double for
+    // BlockField and in Fixed for FixedBlockField.
+    template <class Scalar>
+    static bool willCollide(Scalar y, int below, const std::vector<Scalar>& ys, Scalar floorY, Scalar size, Scalar speed) {
+        if (y + size + speed > floorY) {
+            return true;
+        }
+        return below >= 0 && ys[below] < y + speed + size && ys[below] + size > y;
+    }
+
+    // Number of fallingSpeed steps a block at y takes before the next step
+    // would push its bottom past limit. Positions are whole numbers on the
+    // shipped board, so this agrees exactly with stepping tick by tick.
+    static std::uint64_t movesUntilBlocked(double y, double limit) {
+        const auto blocked = [&](std::uint64_t moves) {
+            return y + fallingSpeed * static_cast<double>(moves) + size + fallingSpeed > limit;
+        };
+        const double estimate = (limit - size - fallingSpeed - y) / fallingSpeed;
+        auto moves = estimate < 0.0 ? std::uint64_t(0) : static_cast<std::uint64_t>(estimate);
+        while (moves > 0 && blocked(moves - 1)) {
+            --moves;
+        }
+        while (!blocked(moves)) {
+            ++moves;
+        }
+        return moves;
+    }
+};
+
+}
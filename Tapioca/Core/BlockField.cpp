@@ -0,0 +1,378 @@
+#include "BlockField.h"
+#include <algorithm>
+#include "Profiler.h"
+
+namespace tapioca {
+
+BlockField::BlockField(const Board& board, FallingMode mode) :
+    board(board),
+    mode(mode) {
+    columnIndex.reset(board);
+    grid.reset(board);
+    // A column holds at most a block per resting row and one at the spawn
+    // point; past that the arrays just grow.
+    reserve(grid.getNumRows() + 1);
+}
+
+void BlockField::clear() {
+    tick = 0;
+    toppedOut = false;
+    hash = 0;
+    xs.clear();
+    ys.clear();
+    fallTicks.clear();
+    landingTicks.clear();
+    columns.clear();
+    flags.clear();
+    ids.clear();
+    nextSerial = 0;
+    slots.clear();
+    columnIndex.clear();
+    grid.clear();
+    awakeBlocks.clear();
+    landings.clear();
+    // Copies of a field only get the capacity they use.
+    reserve(grid.getNumRows() + 1);
+}
+
+void BlockField::reserve(int blocksPerColumn) {
+    const auto blocks = static_cast<std::size_t>(board.numBlocksX) * blocksPerColumn;
+    xs.reserve(blocks);
+    ys.reserve(blocks);
+    fallTicks.reserve(blocks);
+    landingTicks.reserve(blocks);
+    columns.reserve(blocks);
+    flags.reserve(blocks);
+    ids.reserve(blocks);
+    slots.reserve(blocks);
+    columnIndex.reserve(blocksPerColumn);
+    awakeBlocks.reserve(blocks);
+    landings.reserve(blocks);
+    above.reserve(blocksPerColumn);
+}
+
+BlockId BlockField::spawn(int column, std::uint64_t tick) {
+    // The block is at the spawn point at the end of tick and first moves in the next update.
+    const int index = size();
+    xs.push_back(board.columnX(column));
+    ys.push_back(-Block::size);
+    fallTicks.push_back(tick);
+    landingTicks.push_back(Block::neverLands);
+    columns.push_back(column);
+    flags.push_back(Block::Moving);
+    ids.push_back(slots.add(index, nextSerial++));
+    columnIndex.add(columns, index);
+    hash ^= getKey(index);
+    if (mode == FallingMode::Analytic) {
+        scheduleFall(index, tick);
+        pushLanding(index);
+    } else {
+        awakeBlocks.push_back(index);
+    }
+    return ids[index];
+}
+
+bool BlockField::update(std::uint64_t tick) {
+    TAPIOCA_ZONE("BlockField::update");
+    this->tick = tick;
+    return mode == FallingMode::Analytic ? updateAnalytic() : updateStepped();
+}
+
+bool BlockField::updateStepped() {
+    TAPIOCA_COUNT(willCollideChecks, awakeBlocks.size());
+    for (const int i : awakeBlocks) {
+        // The block below has already been updated for this tick.
+        if (willCollide(i)) {
+            hash ^= getKey(i);
+            flags[i] = (flags[i] & ~Block::Moving) | Block::Asleep;
+            fallTicks[i] = tick;
+            hash ^= getKey(i);
+            if (!settle(i)) {
+                return false;
+            }
+        } else {
+            // Moving on by one tick keeps the key.
+            flags[i] |= Block::Moving;
+            ys[i] += Block::fallingSpeed;
+            fallTicks[i] = tick;
+        }
+    }
+    TAPIOCA_ZONE("BlockField::compact");
+    awakeBlocks.erase(
+        std::remove_if(awakeBlocks.begin(), awakeBlocks.end(),
+            [this](int i) { return isAsleep(i); }),
+        awakeBlocks.end());
+    return true;
+}
+
+bool BlockField::updateAnalytic() {
+    while (!landings.empty() && landings.front().first <= tick) {
+        const auto landing = landings.front();
+        std::pop_heap(landings.begin(), landings.end(), std::greater<Landing>());
+        landings.pop_back();
+        const int index = slots.find(landing.second);
+        if (index < 0 || landingTicks[index] != landing.first) {
+            continue;
+        }
+        land(index);
+        if (!settle(index)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Destruction is the only event that can set settled blocks moving again,
+// so the whole column above the destroyed block starts falling here.
+void BlockField::remove(int index) {
+    TAPIOCA_ZONE("BlockField::remove");
+    above.clear();
+    hash ^= getKey(index);
+    unsettle(index);
+    columnIndex.forEachAbove(columns, index, [&](int i) {
+        unsettle(i);
+        above.push_back(i);
+    });
+    const int last = size() - 1;
+    erase(index);
+
+    for (int i : above) {
+        // erase() moved the last block into the removed one's place.
+        if (i == last) {
+            i = index;
+        }
+        if (mode == FallingMode::Analytic) {
+            scheduleFall(i, tick);
+            pushLanding(i);
+        } else if (isAsleep(i)) {
+            hash ^= getKey(i);
+            flags[i] &= ~Block::Asleep;
+            fallTicks[i] = tick;
+            hash ^= getKey(i);
+            wake(i);
+        }
+    }
+}
+
+void BlockField::save(Snapshot& snapshot) const {
+    snapshot.write(tick);
+    snapshot.write(toppedOut);
+    snapshot.writeArray(xs);
+    snapshot.writeArray(ys);
+    snapshot.writeArray(fallTicks);
+    snapshot.writeArray(landingTicks);
+    snapshot.writeArray(columns);
+    snapshot.writeArray(flags);
+    snapshot.writeArray(ids);
+    snapshot.write(nextSerial);
+    slots.save(snapshot);
+    grid.save(snapshot);
+}
+
+void BlockField::restore(Snapshot::Reader& reader) {
+    reader.read(tick);
+    reader.read(toppedOut);
+    reader.readArray(xs);
+    reader.readArray(ys);
+    reader.readArray(fallTicks);
+    reader.readArray(landingTicks);
+    reader.readArray(columns);
+    reader.readArray(flags);
+    reader.readArray(ids);
+    reader.read(nextSerial);
+    slots.restore(reader, ids);
+    grid.restore(reader);
+    columnIndex.rebuild(columns, [this](int a, int b) { return spawnedBefore(a, b); });
+    rebuildSchedule();
+    hash = computeHash();
+}
+
+std::uint64_t BlockField::computeHash() const {
+    std::uint64_t h = 0;
+    for (int i = 0; i < size(); ++i) {
+        h ^= getKey(i);
+    }
+    return h;
+}
+
+// Recreates the update lists from the block state: the awake blocks in
+// stepped mode, the landings in analytic mode.
+void BlockField::rebuildSchedule() {
+    if (mode == FallingMode::Analytic) {
+        landings.clear();
+        for (int i = 0; i < size(); ++i) {
+            if (landingTicks[i] != Block::neverLands) {
+                pushLanding(i);
+            }
+        }
+    } else {
+        awakeBlocks.clear();
+        for (int i = 0; i < size(); ++i) {
+            if (!isAsleep(i)) {
+                awakeBlocks.push_back(i);
+            }
+        }
+        std::sort(awakeBlocks.begin(), awakeBlocks.end(), [this](int a, int b) { return spawnedBefore(a, b); });
+    }
+}
+
+// Stepped mode. Adds a block that starts falling again to the awake blocks.
+void BlockField::wake(int index) {
+    const auto it = std::lower_bound(awakeBlocks.begin(), awakeBlocks.end(), index,
+        [this](int a, int b) { return spawnedBefore(a, b); });
+    awakeBlocks.insert(it, index);
+}
+
+void BlockField::pushLanding(int index) {
+    if (landings.size() == landings.capacity()) {
+        pruneLandings();
+    }
+    landings.emplace_back(landingTicks[index], ids[index]);
+    std::push_heap(landings.begin(), landings.end(), std::greater<Landing>());
+}
+
+// Drops the landings that updateAnalytic() would skip, rather than growing
+// the heap for them.
+void BlockField::pruneLandings() {
+    landings.erase(
+        std::remove_if(landings.begin(), landings.end(), [this](const Landing& landing) {
+            const int index = slots.find(landing.second);
+            return index < 0 || landingTicks[index] != landing.first;
+        }),
+        landings.end());
+    std::make_heap(landings.begin(), landings.end(), std::greater<Landing>());
+}
+
+// Records a block that has come to rest. Returns false if it tops out.
+bool BlockField::settle(int index) {
+    const double y = getPosY(index);
+    const int row = grid.getRowAt(y);
+    if (row >= 0) {
+        grid.set(columns[index], row);
+    } else {
+        // Only a block spawned overlapping the one below it stops off the
+        // rows, and that can only happen at the top of the board.
+        toppedOut = toppedOut || y <= 0.0;
+    }
+    return !toppedOut && !grid.isToppedOut();
+}
+
+void BlockField::unsettle(int index) {
+    if (isAsleep(index)) {
+        const int row = grid.getRowAt(getPosY(index));
+        if (row >= 0) {
+            grid.clear(columns[index], row);
+        }
+    }
+}
+
+int BlockField::firstSwept(const Rect& rect, Vec2 delta) const {
+    const Rect from(rect.x - delta.x, rect.y - delta.y, rect.w, rect.h);
+    // Covers the whole move, and blocks that moved down into it.
+    const double left = std::min(from.x, rect.x);
+    const double top = std::min(from.y, rect.y);
+    const Rect path(left, top, std::max(from.right(), rect.right()) - left,
+        std::max(from.bottom(), rect.bottom()) - top + Block::fallingSpeed);
+
+    int first = -1;
+    double firstTime = 0.0;
+    std::uint64_t tests = 0;
+    forEachOverlapping(path, [&](int index) {
+        ++tests;
+        const double fall = isMoving(index) ? Block::fallingSpeed : 0.0;
+        auto block = getRect(index);
+        block.y -= fall;
+        // Relative to the block.
+        const double time = sweep(from, Vec2(delta.x, delta.y - fall), block);
+        if (time >= 0.0 && (first < 0 || time < firstTime || (time == firstTime && spawnedBefore(index, first)))) {
+            first = index;
+            firstTime = time;
+        }
+        return false;
+    });
+    TAPIOCA_COUNT(sweepTests, tests);
+    return first;
+}
+
+std::uint64_t BlockField::getContactTick(const Rect& rect) const {
+    auto contact = Block::neverLands;
+    const auto range = columnIndex.getColumnRange(rect);
+    for (int c = range.first; c <= range.second; ++c) {
+        for (const int i : columnIndex.getColumn(c)) {
+            const double bottom = getPosY(i) + Block::size;
+            if (landingTicks[i] == Block::neverLands || bottom > rect.y) {
+                continue;
+            }
+            // Ticks until the bottom passes rect.y, minus one for safety.
+            const auto ticks = static_cast<std::uint64_t>((rect.y - bottom) / Block::fallingSpeed);
+            if (tick + ticks < landingTicks[i]) {
+                contact = std::min(contact, tick + std::max<std::uint64_t>(ticks, 1));
+            }
+        }
+    }
+    return contact;
+}
+
+// Stepped mode. Only the floor and the next block down in the same column
+// can stop a block.
+bool BlockField::willCollide(int index) const {
+    return Block::willCollide(ys[index], columnIndex.below(columns, index), ys, board.floorY(), Block::size,
+        Block::fallingSpeed);
+}
+
+// Analytic mode. Starts falling from the position at the end of fromTick and
+// computes the tick the block will stop in. The block below must already be
+// scheduled.
+void BlockField::scheduleFall(int index, std::uint64_t fromTick) {
+    const double y = getPosY(index, fromTick);
+    hash ^= getKey(index);
+    ys[index] = y;
+    fallTicks[index] = fromTick;
+    flags[index] = (flags[index] | Block::Moving) & ~Block::Asleep;
+    hash ^= getKey(index);
+
+    auto moves = Block::movesUntilBlocked(y, board.floorY());
+    const int below = columnIndex.below(columns, index);
+    if (below >= 0) {
+        // Both fall at the same speed, so the gap to a falling block below
+        // stays the same until it lands: either it blocks this one right
+        // away or only once it has come to rest.
+        if (y + Block::size + Block::fallingSpeed > getPosY(below, fromTick + 1)) {
+            moves = 0;
+        } else {
+            moves = std::min(moves, Block::movesUntilBlocked(y, getRestingY(below)));
+        }
+    }
+    landingTicks[index] = fromTick + 1 + moves;
+}
+
+// Analytic mode. Settles the block at its landing tick.
+void BlockField::land(int index) {
+    hash ^= getKey(index);
+    ys[index] = getRestingY(index);
+    fallTicks[index] = landingTicks[index];
+    landingTicks[index] = Block::neverLands;
+    flags[index] = (flags[index] & ~Block::Moving) | Block::Asleep;
+    hash ^= getKey(index);
+}
+
+// Moves the last block into the place of the removed one and updates what
+// refers to it by index. Landings refer to blocks by id and need nothing.
+void BlockField::erase(int index) {
+    const int last = size() - 1;
+    if (mode == FallingMode::Stepped) {
+        const auto removed = std::find(awakeBlocks.begin(), awakeBlocks.end(), index);
+        if (removed != awakeBlocks.end()) {
+            awakeBlocks.erase(removed);
+        }
+        std::replace(awakeBlocks.begin(), awakeBlocks.end(), last, index);
+    }
+    columnIndex.remove(columns, index);
+    slots.remove(ids[index]);
+    if (index != last) {
+        slots.move(ids[last], index);
+    }
+    swapRemove(index, xs, ys, fallTicks, landingTicks, columns, flags, ids);
+}
+
+}
@@ -0,0 +1,264 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+#include "Block.h"
+#include "Board.h"
+#include "ColumnIndex.h"
+#include "Counters.h"
+#include "Geometry.h"
+#include "SettledGrid.h"
+#include "SlotTable.h"
+#include "Snapshot.h"
+#include "Zobrist.h"
+
+namespace tapioca {
+
+enum class FallingMode {
+    // Every awake block checks for a collision and moves each tick.
+    Stepped,
+    // Landing ticks are computed when a block starts falling and kept in a
+    // priority queue; positions are evaluated from the fall start on demand.
+    Analytic
+};
+
+// Refers to a block for as long as it exists, unlike its index, which
+// changes when another block is removed. Looking one up costs O(1).
+using BlockId = SlotTable::Handle;
+constexpr BlockId noBlock = SlotTable::none;
+
+// All blocks of a game together with the structures used to update and
+// query them. Queries refer to the state at the end of the tick passed to
+// the last update().
+//
+// Blocks are stored as parallel arrays indexed by block index so that the
+// collision loops only touch the fields they test. Removing a block moves
+// the last one into its place, so indices are not in spawn order; where
+// the rules need an order, as in ties between blocks, they use the spawn
+// order, which is the order the blocks were once stored in. In stepped mode a
+// block's y is integrated every tick. In analytic mode a falling block
+// stores the y it had at the end of its fallTick together with the tick it
+// will land in, and its position at any tick in between is evaluated on
+// demand.
+class BlockField {
+public:
+    // Reserves room for a board full of blocks, so that the field does not
+    // allocate while it is being played.
+    BlockField(const Board& board, FallingMode mode);
+
+    // Removes every block and starts over at tick 0, as a new field of the
+    // same board and mode would, but keeping the memory.
+    void clear();
+
+    // Drops a new block into the given column. It is at the spawn point at
+    // the end of tick and first moves in the next update.
+    BlockId spawn(int column, std::uint64_t tick);
+
+    // Advances every block into the given tick. Returns false if a block
+    // came to rest touching the top of the board.
+    // Throws std::invalid_argument for boards wider than SettledGrid::maxColumns.
+    bool update(std::uint64_t tick);
+
+    // Marks a block as hit. It keeps colliding until remove() is called.
+    void destroy(int index) {
+        flags[index] |= Block::Destroyed;
+    }
+
+    // Removes a destroyed block and sets the blocks above it falling. Costs
+    // the height of its column and the number of awake blocks, not the
+    // number of blocks.
+    void remove(int index);
+
+    // restore() expects a snapshot of a field with the same board and mode.
+    void save(Snapshot& snapshot) const;
+    void restore(Snapshot::Reader& reader);
+
+    // Returns the earliest spawned block intersecting rect, or -1.
+    int firstOverlapping(const Rect& rect) const {
+        int first = -1;
+        forEachOverlapping(rect, [&](int index) {
+            if (first < 0 || spawnedBefore(index, first)) {
+                first = index;
+            }
+            return false;
+        });
+        return first;
+    }
+
+    // Returns the block that rect, having just moved by delta, ran into on the
+    // way: the one it met first, accounting for the blocks that moved in the
+    // last update, with ties going to the earliest spawned. -1 if none.
+    int firstSwept(const Rect& rect, Vec2 delta) const;
+
+    // Calls f(index) for every block intersecting rect until f returns true.
+    // Returns whether f returned true. Counts the rect tests in
+    // threadCounters once per call, keeping TLS writes out of the loop.
+    template <class F>
+    bool forEachOverlapping(const Rect& rect, F f) const {
+        std::uint64_t tests = 0;
+        const bool found = columnIndex.forEachOverlapping(columnIndex.getColumnRange(rect), rect,
+            [this](int index) { return getRect(index); }, f, tests);
+        TAPIOCA_COUNT(collisionTests, tests);
+        return found;
+    }
+
+    // Tick of the next scheduled landing in analytic mode, Block::neverLands if none.
+    std::uint64_t getNextLandingTick() const {
+        return landings.empty() ? Block::neverLands : landings.front().first;
+    }
+
+    // Analytic mode. Returns a tick no later than the first one in which a
+    // falling block could reach rect from above, Block::neverLands if none will.
+    std::uint64_t getContactTick(const Rect& rect) const;
+
+    FallingMode getMode() const {
+        return mode;
+    }
+
+    int size() const {
+        return static_cast<int>(ys.size());
+    }
+
+    BlockId getId(int index) const {
+        return ids[index];
+    }
+
+    // Returns the index of the block with the given id, or -1 once it has
+    // been removed.
+    int find(BlockId id) const {
+        return slots.find(id);
+    }
+
+    // Ids grow in spawn order.
+    bool spawnedBefore(int a, int b) const {
+        return ids[a] < ids[b];
+    }
+
+    double getPosY(int index) const {
+        return getPosY(index, tick);
+    }
+
+    // Whether the block moved in the last update.
+    bool isMoving(int index) const {
+        if (landingTicks[index] == Block::neverLands) {
+            return (flags[index] & Block::Moving) != 0;
+        }
+        return (flags[index] & Block::Moving) && tick > fallTicks[index] && tick < landingTicks[index];
+    }
+
+    bool isDestroyed(int index) const {
+        return (flags[index] & Block::Destroyed) != 0;
+    }
+
+    bool isAsleep(int index) const {
+        return (flags[index] & Block::Asleep) != 0;
+    }
+
+    int getColumn(int index) const {
+        return columns[index];
+    }
+
+    Rect getRect(int index) const {
+        return Rect(xs[index], getPosY(index), Block::size, Block::size);
+    }
+
+    // Height of the block for scoring, from 0 at the bottom of the board to 1 at the top.
+    double getHitHeight(int index) const {
+        return 1.0 - getPosY(index) / board.height;
+    }
+
+    const ColumnIndex& getColumnIndex() const {
+        return columnIndex;
+    }
+
+    // Bitboard of the blocks at rest; falling blocks are not included.
+    const SettledGrid& getSettledGrid() const {
+        return grid;
+    }
+
+    // Zobrist hash of the blocks, kept up to date as they spawn, land, start
+    // falling again and are removed. A falling block is hashed by where its
+    // fall would put it at tick 0, which stays the same while it falls, so
+    // moving blocks cost nothing. Both falling modes give the same hash for
+    // the same blocks.
+    std::uint64_t getHash() const {
+        return hash;
+    }
+
+    // The same hash computed from every block, for checking.
+    std::uint64_t computeHash() const;
+
+private:
+    // Landing tick and id of a falling block.
+    using Landing = std::pair<std::uint64_t, BlockId>;
+
+    Board board;
+    FallingMode mode;
+    std::uint64_t tick = 0;
+    // Per-block state.
+    std::vector<double> xs;
+    std::vector<double> ys;
+    std::vector<std::uint64_t> fallTicks;
+    std::vector<std::uint64_t> landingTicks;
+    std::vector<int> columns;
+    std::vector<std::uint8_t> flags;
+    std::vector<BlockId> ids;
+    std::uint32_t nextSerial = 0;
+    SlotTable slots;
+    ColumnIndex columnIndex;
+    SettledGrid grid;
+    bool toppedOut = false;
+    std::uint64_t hash = 0;
+    // Stepped mode: indices of blocks that are not asleep, in spawn order, so
+    // that a block below has always moved first.
+    std::vector<int> awakeBlocks;
+    // Analytic mode: min-heap of the landings of every falling block. Entries
+    // of blocks that have been removed or rescheduled since are skipped.
+    std::vector<Landing> landings;
+    // Reused by remove().
+    std::vector<int> above;
+
+    // Position at the end of the given tick, which must not precede fallTick.
+    double getPosY(int index, std::uint64_t tick) const {
+        const auto landingTick = landingTicks[index];
+        if (!(flags[index] & Block::Moving) || landingTick == Block::neverLands) {
+            return ys[index];
+        }
+        const auto last = std::min(tick, landingTick - 1);
+        const auto fallTick = fallTicks[index];
+        return last > fallTick ? ys[index] + Block::fallingSpeed * static_cast<double>(last - fallTick) : ys[index];
+    }
+
+    // Where a scheduled fall will end; the current position if none is scheduled.
+    double getRestingY(int index) const {
+        return landingTicks[index] == Block::neverLands ? ys[index] : getPosY(index, landingTicks[index]);
+    }
+
+    // Zobrist key of a block; depends only on its column, flags, ys and fallTicks.
+    std::uint64_t getKey(int index) const {
+        if (isAsleep(index)) {
+            return zobrist::key(zobrist::RestingBlock, columns[index], zobrist::quantize(ys[index]));
+        }
+        const double start = ys[index] - Block::fallingSpeed * static_cast<double>(fallTicks[index]);
+        return zobrist::key(zobrist::FallingBlock, columns[index], zobrist::quantize(start));
+    }
+
+    bool updateStepped();
+    bool updateAnalytic();
+    bool willCollide(int index) const;
+    void scheduleFall(int index, std::uint64_t fromTick);
+    void land(int index);
+    void reserve(int blocksPerColumn);
+    void erase(int index);
+    void rebuildSchedule();
+    void wake(int index);
+    void pushLanding(int index);
+    void pruneLandings();
+    bool settle(int index);
+    void unsettle(int index);
+};
+
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+namespace tapioca {
+
+constexpr int ticksPerSecond = 60;
+
+constexpr int secondsToTicks(double seconds) {
+    return static_cast<int>(seconds * ticksPerSecond + 0.5);
+}
+
+// Playfield dimensions. The front-end fills these from the window size;
+// headless runs use the defaults, which match the shipped 400x600 window.
+struct Board {
+    double width = 400.0;
+    double height = 600.0;
+    double floorHeight = 80.0;
+    int numBlocksX = 8;
+    // Added to the vertical speed of the player and the egg every tick.
+    double gravity = 1.5;
+    // Horizontal and initial upward speed of a thrown egg.
+    double eggSpeed = 20.0;
+    // Also tests the path an egg moved along since the last update, so that
+    // fast eggs cannot pass through blocks. Shipped eggs already skip some:
+    // over the 100 random games of `sweep` they destroy 6.2 blocks a game
+    // without it and 7.0 with it, so about one hit in nine is lost. It stays
+    // off because the shipped game is defined by the discrete test: version
+    // 2 replays, EggFlight's aim tables and FixedWorld all assume it.
+    bool sweptCollision = false;
+
+    constexpr double floorY() const {
+        return height - floorHeight;
+    }
+
+    constexpr double columnX(int column) const {
+        return column * width / static_cast<double>(numBlocksX);
+    }
+
+    constexpr bool operator==(const Board& other) const {
+        return width == other.width && height == other.height && floorHeight == other.floorHeight &&
+            numBlocksX == other.numBlocksX && gravity == other.gravity && eggSpeed == other.eggSpeed &&
+            sweptCollision == other.sweptCollision;
+    }
+
+    constexpr bool operator!=(const Board& other) const {
+        return !(*this == other);
+    }
+};
+
+}
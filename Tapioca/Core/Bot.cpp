@@ -0,0 +1,168 @@
+#include "Bot.h"
+#include <algorithm>
+#include <climits>
+#include "Profiler.h"
+
+namespace tapioca {
+
+const int Bot::actionTicks = 6;
+const int Bot::defaultDepth = 3;
+
+const std::array<Input, Bot::numActions> Bot::actions = { {
+    { false, false, false, false },
+    { true, false, false, false },
+    { false, true, false, false },
+    { false, false, true, false },
+    { true, false, true, false },
+    { false, true, true, false },
+    { false, false, false, true },
+    { true, false, false, true },
+    { false, true, false, true },
+} };
+
+namespace {
+
+// Below any position the game goes on in; losing later is less bad.
+constexpr int lostValue = INT_MIN / 2;
+// Per squared settled block in a column, so tall stacks are cleared first.
+constexpr int stackPenalty = 10;
+// Per falling block above the player.
+constexpr int dangerPenalty = 50;
+
+int evaluate(const World& world) {
+    if (world.isGameOver()) {
+        return lostValue + static_cast<int>(std::min<std::uint64_t>(world.getTick(), INT_MAX / 4));
+    }
+    const auto& blocks = world.getBlocks();
+    const auto& grid = blocks.getSettledGrid();
+    int value = world.getScore();
+    for (int c = 0; c < world.getBoard().numBlocksX; ++c) {
+        const int height = grid.getColumnHeight(c);
+        value -= stackPenalty * height * height;
+    }
+    const auto& rect = world.getPlayer().getRect();
+    blocks.forEachOverlapping(Rect(rect.x, -Block::size, rect.w, rect.y + Block::size), [&](int i) {
+        if (blocks.isMoving(i)) {
+            value -= dangerPenalty;
+        }
+        return false;
+    });
+    return value;
+}
+
+void play(World& world, const Input& input) {
+    for (int t = 0; t < Bot::actionTicks && !world.isGameOver(); ++t) {
+        world.step(input);
+    }
+}
+
+}
+
+Bot::Bot(int depth, unsigned numThreads, int tableBits) :
+    depth(std::max(1, depth)),
+    table(new Entry[std::size_t(1) << tableBits]),
+    tableMask((std::uint64_t(1) << tableBits) - 1),
+    searches(numActions) {
+    for (auto& s : searches) {
+        s.plies.resize(this->depth);
+    }
+    if (numThreads != 1) {
+        pool = std::make_unique<ThreadPool>(numThreads);
+    }
+}
+
+void Bot::reset() {
+    ticksLeft = 0;
+}
+
+Input Bot::decide(const World& world) {
+    if (ticksLeft > 0) {
+        --ticksLeft;
+        return current;
+    }
+
+    TAPIOCA_ZONE("Bot::decide");
+    for (int a = 0; a < numActions; ++a) {
+        searches[a].world = world;
+        if (pool) {
+            pool->submit([this, a] { searchRoot(a); });
+        } else {
+            searchRoot(a);
+        }
+    }
+    if (pool) {
+        pool->wait();
+    }
+
+    // The first of equally good choices, so the result does not depend on
+    // which search finished first.
+    int best = 0;
+    for (int a = 0; a < numActions; ++a) {
+        nodes += searches[a].nodes;
+        tableHits += searches[a].tableHits;
+        searches[a].nodes = searches[a].tableHits = 0;
+        if (searches[a].value > searches[best].value) {
+            best = a;
+        }
+    }
+    current = actions[best];
+    ticksLeft = actionTicks - 1;
+    return current;
+}
+
+void Bot::searchRoot(int action) {
+    TAPIOCA_ZONE("Bot::searchRoot");
+    auto& s = searches[action];
+    play(s.world, actions[action]);
+    s.value = search(s, 1);
+}
+
+// Value of s.world for the best of the choices left after ply of them.
+// Leaves s.world in an unspecified position.
+int Bot::search(Search& s, int ply) {
+    ++s.nodes;
+    if (ply == depth || s.world.isGameOver()) {
+        return evaluate(s.world);
+    }
+
+    // The value of a position also depends on how far it is searched.
+    const auto key = s.world.getHash() + static_cast<std::uint64_t>(depth - ply);
+    int value;
+    if (probe(key, value)) {
+        ++s.tableHits;
+        return value;
+    }
+
+    auto& snapshot = s.plies[ply];
+    s.world.save(snapshot);
+
+    value = INT_MIN;
+    for (int a = 0; a < numActions; ++a) {
+        if (a > 0) {
+            s.world.restore(snapshot);
+        }
+        play(s.world, actions[a]);
+        value = std::max(value, search(s, ply + 1));
+    }
+    store(key, value);
+    return value;
+}
+
+bool Bot::probe(std::uint64_t key, int& value) const {
+    const auto& entry = table[key & tableMask];
+    const auto data = entry.data.load(std::memory_order_relaxed);
+    if ((entry.check.load(std::memory_order_relaxed) ^ data) != key) {
+        return false;
+    }
+    value = static_cast<int>(static_cast<std::uint32_t>(data));
+    return true;
+}
+
+void Bot::store(std::uint64_t key, int value) {
+    auto& entry = table[key & tableMask];
+    const std::uint64_t data = static_cast<std::uint32_t>(value);
+    entry.check.store(key ^ data, std::memory_order_relaxed);
+    entry.data.store(data, std::memory_order_relaxed);
+}
+
+}
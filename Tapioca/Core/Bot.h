@@ -0,0 +1,87 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "Input.h"
+#include "Snapshot.h"
+#include "ThreadPool.h"
+#include "World.h"
+
+namespace tapioca {
+
+// Computer player. Every actionTicks ticks it plays each sequence of depth
+// choices of buttons on copies of the game and keeps to the first choice of
+// the best one until the next search. The choices at the root are searched
+// in parallel; positions reached more than once, by any thread, are looked
+// up by World::getHash() in a shared transposition table instead of being
+// searched again. Searching is deterministic: the same game gets the same
+// inputs whatever the number of threads.
+class Bot {
+public:
+    static const int actionTicks;
+    static const int defaultDepth;
+    static constexpr int numActions = 9;
+    static const std::array<Input, numActions> actions;
+
+    // With numThreads other than 1 the search runs on a ThreadPool of that
+    // many workers, 0 picking one per hardware thread. The transposition
+    // table holds 2^tableBits entries.
+    explicit Bot(int depth = defaultDepth, unsigned numThreads = 1, int tableBits = 18);
+
+    // Forgets the current choice, so the next call to decide() searches.
+    void reset();
+
+    // Buttons to hold in the next tick of world.
+    Input decide(const World& world);
+
+    int getDepth() const {
+        return depth;
+    }
+
+    // Positions evaluated and transposition table hits since construction.
+    std::uint64_t getNodes() const {
+        return nodes;
+    }
+
+    std::uint64_t getTableHits() const {
+        return tableHits;
+    }
+
+private:
+    // The key is stored xor-ed with the data, so an entry torn by two
+    // threads writing at once does not match either key.
+    struct Entry {
+        std::atomic<std::uint64_t> check{ 0 };
+        std::atomic<std::uint64_t> data{ 0 };
+    };
+
+    // State of the search of one root choice.
+    struct Search {
+        World world;
+        // Position at each ply, to return to after trying a choice.
+        std::vector<Snapshot> plies;
+        int value = 0;
+        std::uint64_t nodes = 0;
+        std::uint64_t tableHits = 0;
+    };
+
+    int depth;
+    std::unique_ptr<Entry[]> table;
+    std::uint64_t tableMask;
+    std::vector<Search> searches;
+    std::unique_ptr<ThreadPool> pool;
+    Input current;
+    int ticksLeft = 0;
+    std::uint64_t nodes = 0;
+    std::uint64_t tableHits = 0;
+
+    void searchRoot(int action);
+    int search(Search& s, int ply);
+    bool probe(std::uint64_t key, int& value) const;
+    void store(std::uint64_t key, int value);
+};
+
+}
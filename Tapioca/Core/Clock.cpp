@@ -0,0 +1,7 @@
+#include "Clock.h"
+
+namespace tapioca {
+
+const int FixedStepClock::maxTicksPerAdvance = secondsToTicks(0.25);
+
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "Board.h"
+
+namespace tapioca {
+
+// Turns the real time between rendered frames into whole simulation ticks,
+// carrying the remainder over to the next frame. The simulation then runs
+// at ticksPerSecond whatever the display rate is.
+class FixedStepClock {
+public:
+    // After a long stall the game slows down rather than jumping ahead.
+    static const int maxTicksPerAdvance;
+
+    // Adds the seconds elapsed since the last call and returns the number of
+    // ticks to step now.
+    int advance(double seconds) {
+        accumulator += seconds * ticksPerSecond;
+        int ticks = static_cast<int>(accumulator);
+        accumulator -= ticks;
+        if (ticks > maxTicksPerAdvance) {
+            ticks = maxTicksPerAdvance;
+        }
+        return ticks;
+    }
+
+    void reset() {
+        accumulator = 0.0;
+    }
+
+private:
+    // Fraction of a tick that has elapsed but not been stepped.
+    double accumulator = 0.0;
+};
+
+}
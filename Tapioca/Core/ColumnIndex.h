@@ -0,0 +1,143 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "Block.h"
+#include "Board.h"
+#include "Geometry.h"
+
+namespace tapioca {
+
+// Blocks never leave the column they spawned in and never pass each other,
+// so keeping each column's blocks in bottom-to-top order answers neighbour
+// and overlap queries without scanning the whole block list.
+// Entries are indices into the BlockField's block arrays; blockColumns is
+// its per-block column array.
+class ColumnIndex {
+public:
+    void reset(const Board& board) {
+        this->board = board;
+        columns.assign(board.numBlocksX, {});
+        slots.clear();
+    }
+
+    // Empties every column, keeping their memory.
+    void clear() {
+        for (auto& column : columns) {
+            column.clear();
+        }
+        slots.clear();
+    }
+
+    // Makes room for blocksPerColumn blocks in every column, so that adding
+    // and rebuilding do not allocate below that.
+    void reserve(int blocksPerColumn) {
+        for (auto& column : columns) {
+            column.reserve(blocksPerColumn);
+        }
+        slots.reserve(columns.size() * blocksPerColumn);
+    }
+
+    // Registers block index, which must have been appended on top of its column.
+    void add(const std::vector<int>& blockColumns, int index) {
+        auto& column = columns.at(blockColumns[index]);
+        slots.resize(blockColumns.size());
+        slots[index] = static_cast<int>(column.size());
+        column.push_back(index);
+    }
+
+    // Unregisters block index ahead of swapRemove, which moves the last
+    // block into its place: blockColumns must still hold both. Costs the
+    // height of the columns involved.
+    void remove(const std::vector<int>& blockColumns, int index) {
+        auto& column = columns[blockColumns[index]];
+        const int slot = slots[index];
+        column.erase(column.begin() + slot);
+        for (auto s = static_cast<std::size_t>(slot); s < column.size(); ++s) {
+            --slots[column[s]];
+        }
+        const int last = static_cast<int>(slots.size()) - 1;
+        if (index != last) {
+            columns[blockColumns[last]][slots[last]] = index;
+            slots[index] = slots[last];
+        }
+        slots.pop_back();
+    }
+
+    // Recreates the columns from the blocks' columns. A column holds its
+    // blocks in the order they were spawned; before(a, b) tells whether
+    // block a was spawned before block b.
+    template <class Before>
+    void rebuild(const std::vector<int>& blockColumns, Before before) {
+        clear();
+        slots.resize(blockColumns.size());
+        for (int i = 0; i < static_cast<int>(blockColumns.size()); ++i) {
+            columns.at(blockColumns[i]).push_back(i);
+        }
+        for (auto& column : columns) {
+            std::sort(column.begin(), column.end(), before);
+            for (std::size_t slot = 0; slot < column.size(); ++slot) {
+                slots[column[slot]] = static_cast<int>(slot);
+            }
+        }
+    }
+
+    // Returns the index of the block directly beneath block index, or -1.
+    int below(const std::vector<int>& blockColumns, int index) const {
+        const int slot = slots[index];
+        return slot > 0 ? columns[blockColumns[index]][slot - 1] : -1;
+    }
+
+    // Calls f(index) for every block above block index in its column, bottom to top.
+    template <class F>
+    void forEachAbove(const std::vector<int>& blockColumns, int index, F f) const {
+        const auto& column = columns[blockColumns[index]];
+        for (auto slot = static_cast<std::size_t>(slots[index]) + 1; slot < column.size(); ++slot) {
+            f(column[slot]);
+        }
+    }
+
+    // Calls f(index) for every block in the columns of range whose rect,
+    // rectOf(index), intersects rect, until f returns true. Returns whether
+    // f returned true. Adds the number of rect tests to tests. Rects are
+    // Rect or FixedRect.
+    template <class R, class RectOf, class F>
+    bool forEachOverlapping(std::pair<int, int> range, const R& rect, RectOf rectOf, F f, std::uint64_t& tests) const {
+        for (int c = range.first; c <= range.second; ++c) {
+            const auto& column = columns[c];
+            // Bottom-to-top order means y is descending; skip blocks entirely below rect.
+            auto it = std::partition_point(column.begin(), column.end(),
+                [&](int index) { return rectOf(index).y >= rect.bottom(); });
+            for (; it != column.end() && rectOf(*it).bottom() > rect.y; ++it) {
+                ++tests;
+                if (rect.intersects(rectOf(*it)) && f(*it)) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    // Returns the block indices of column c, bottom to top.
+    const std::vector<int>& getColumn(int c) const {
+        return columns[c];
+    }
+
+    // Returns the range of columns whose blocks may intersect rect.
+    std::pair<int, int> getColumnRange(const Rect& rect) const {
+        const double columnWidth = board.width / board.numBlocksX;
+        return {
+            std::max(0, static_cast<int>((rect.x - Block::size) / columnWidth)),
+            std::min(board.numBlocksX - 1, static_cast<int>(rect.right() / columnWidth))
+        };
+    }
+
+private:
+    Board board;
+    std::vector<std::vector<int>> columns;
+    std::vector<int> slots;
+};
+
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstdlib>
+#include <new>
+#include "Counters.h"
+
+// Replaces the global operator new to count allocations in
+// tapioca::threadCounters. Include it in exactly one source file of a
+// program. The array forms forward to these; the aligned forms are left
+// alone and not counted.
+void* operator new(std::size_t size) {
+    ++tapioca::threadCounters.allocations;
+    if (void* p = std::malloc(size > 0 ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
@@ -0,0 +1,57 @@
+#include "CounterLog.h"
+#include <fstream>
+#include <ostream>
+#include <stdexcept>
+
+namespace tapioca {
+
+Counters CounterLog::getTotal() const {
+    Counters total;
+    for (const auto& row : rows) {
+        total.collisionTests += row.second.collisionTests;
+        total.eggTests += row.second.eggTests;
+        total.playerTests += row.second.playerTests;
+        total.sweepTests += row.second.sweepTests;
+        total.willCollideChecks += row.second.willCollideChecks;
+        total.allocations += row.second.allocations;
+    }
+    return total;
+}
+
+void CounterLog::writeCsv(std::ostream& out) const {
+    out << "frame";
+    Counters().forEach([&](const char* name, std::uint64_t) { out << ',' << name; });
+    out << '\n';
+    for (const auto& row : rows) {
+        out << row.first;
+        row.second.forEach([&](const char*, std::uint64_t value) { out << ',' << value; });
+        out << '\n';
+    }
+}
+
+void CounterLog::writeJson(std::ostream& out) const {
+    out << "{\"frames\":[";
+    for (std::size_t i = 0; i < rows.size(); ++i) {
+        out << (i > 0 ? ",\n" : "\n") << "{\"frame\":" << rows[i].first;
+        rows[i].second.forEach([&](const char* name, std::uint64_t value) { out << ",\"" << name << "\":" << value; });
+        out << '}';
+    }
+    out << "\n]}\n";
+}
+
+void CounterLog::save(const std::string& path) const {
+    std::ofstream file(path);
+    if (file) {
+        const std::string json = ".json";
+        if (path.size() >= json.size() && path.compare(path.size() - json.size(), json.size(), json) == 0) {
+            writeJson(file);
+        } else {
+            writeCsv(file);
+        }
+    }
+    if (!file) {
+        throw std::runtime_error("counters: cannot write " + path);
+    }
+}
+
+}
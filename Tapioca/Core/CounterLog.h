@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <utility>
+#include <vector>
+#include "Counters.h"
+
+namespace tapioca {
+
+// Counts of work per frame or tick, saved as CSV or JSON so that runs can be
+// compared for regressions in algorithmic cost.
+class CounterLog {
+public:
+    // counts is the work done in frame, usually the difference of two reads
+    // of threadCounters.
+    void add(std::uint64_t frame, const Counters& counts) {
+        rows.emplace_back(frame, counts);
+    }
+
+    void clear() {
+        rows.clear();
+    }
+
+    int size() const {
+        return static_cast<int>(rows.size());
+    }
+
+    Counters getTotal() const;
+
+    // One row per frame with a column per count.
+    void writeCsv(std::ostream& out) const;
+    // {"frames": [{"frame": n, "collision_tests": n, ...}, ...]}
+    void writeJson(std::ostream& out) const;
+
+    // JSON for paths ending in ".json", CSV otherwise. Throws
+    // std::runtime_error if the file cannot be written.
+    void save(const std::string& path) const;
+
+private:
+    std::vector<std::pair<std::uint64_t, Counters>> rows;
+};
+
+}
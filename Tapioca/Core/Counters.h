@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstdint>
+
+namespace tapioca {
+
+// Work done by one thread, counted where it happens, so that algorithms can
+// be compared by what they do rather than by noisy timings. The counts only
+// grow; callers take the difference between two reads.
+//
+// The counts made in the collision loops are compiled out with
+// TAPIOCA_NO_COUNTERS, which CMake defines unless the option
+// TAPIOCA_COUNTERS is ON, so that benchmarks time the loops alone; they
+// then stay 0. The game's project always counts. Allocations are counted
+// by CountAllocations.h either way, as they cost nothing in a tick that
+// does not allocate.
+struct Counters {
+#ifdef TAPIOCA_NO_COUNTERS
+    static constexpr bool enabled = false;
+#else
+    static constexpr bool enabled = true;
+#endif
+
+    // Rect tests against blocks, by every caller.
+    std::uint64_t collisionTests = 0;
+    // The part of collisionTests made for eggs and for the player.
+    std::uint64_t eggTests = 0;
+    std::uint64_t playerTests = 0;
+    // Swept rect tests of fast eggs.
+    std::uint64_t sweepTests = 0;
+    // Falling blocks checked for landing in stepped mode.
+    std::uint64_t willCollideChecks = 0;
+    // Calls to the global operator new, in programs that include
+    // CountAllocations.h, with or without TAPIOCA_NO_COUNTERS.
+    std::uint64_t allocations = 0;
+
+    Counters operator-(const Counters& other) const {
+        Counters d;
+        d.collisionTests = collisionTests - other.collisionTests;
+        d.eggTests = eggTests - other.eggTests;
+        d.playerTests = playerTests - other.playerTests;
+        d.sweepTests = sweepTests - other.sweepTests;
+        d.willCollideChecks = willCollideChecks - other.willCollideChecks;
+        d.allocations = allocations - other.allocations;
+        return d;
+    }
+
+    // Calls f(name, value) for every count, in declaration order.
+    template <class F>
+    void forEach(F f) const {
+        f("collision_tests", collisionTests);
+        f("egg_tests", eggTests);
+        f("player_tests", playerTests);
+        f("sweep_tests", sweepTests);
+        f("will_collide_checks", willCollideChecks);
+        f("allocations", allocations);
+    }
+};
+
+inline thread_local Counters threadCounters;
+
+// Adds the collision tests made while it is alive to another count too.
+class CountTestsAs {
+public:
+    explicit CountTestsAs(std::uint64_t Counters::*count) :
+        count(count),
+        start(threadCounters.collisionTests) {}
+
+    ~CountTestsAs() {
+        threadCounters.*count += threadCounters.collisionTests - start;
+    }
+
+    CountTestsAs(const CountTestsAs&) = delete;
+    CountTestsAs& operator=(const CountTestsAs&) = delete;
+
+private:
+    std::uint64_t Counters::*count;
+    std::uint64_t start;
+};
+
+}
+
+#ifndef TAPIOCA_NO_COUNTERS
+#define TAPIOCA_COUNT(count, n) (::tapioca::threadCounters.count += (n))
+#define TAPIOCA_COUNT_TESTS_AS(count) \
+    const ::tapioca::CountTestsAs countTestsAs(&::tapioca::Counters::count)
+#else
+#define TAPIOCA_COUNT(count, n) static_cast<void>(n)
+#define TAPIOCA_COUNT_TESTS_AS(count) static_cast<void>(0)
+#endif
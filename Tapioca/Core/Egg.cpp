@@ -0,0 +1,8 @@
+#include "Egg.h"
+
+namespace tapioca {
+
+const int Egg::explosionFrames = 2;
+const int Egg::explosionFrameTicks = secondsToTicks(0.1);
+
+}
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <type_traits>
+#include "BlockField.h"
+#include "Board.h"
+#include "Counters.h"
+#include "Geometry.h"
+#include "Physics.h"
+#include "Profiler.h"
+#include "Zobrist.h"
+
+namespace tapioca {
+
+class Egg {
+public:
+    static const int explosionFrames;
+    static const int explosionFrameTicks;
+    // A constant expression for EggFlight's tables.
+    static constexpr double size = 50.0;
+
+    // The state of an egg, in double for World or in Fixed for FixedWorld.
+    template <class Scalar>
+    struct State {
+        typename Shapes<Scalar>::Rect rect;
+        typename Shapes<Scalar>::Vec2 velocity;
+        int explosionTicks = -1;
+        bool destroyed = false;
+        // Whether velocity holds the move since the last update.
+        bool moved = false;
+    };
+
+    // pos is the top center of the player throwing it.
+    Egg(Vec2 pos, bool right, const Board& board) :
+        state(launch(pos, right, makePhysics<double>(board))) {}
+
+    explicit Egg(const State<double>& state) :
+        state(state) {}
+
+    // Top left of an egg thrown from pos.
+    static constexpr Vec2 getStartPos(Vec2 pos) {
+        return pos - Vec2(size / 2.0, size / 4.0);
+    }
+
+    // An egg thrown from pos, the top center of the player, as getStartPos
+    // places it.
+    template <class Scalar>
+    static State<Scalar> launch(typename Shapes<Scalar>::Vec2 pos, bool right, const Physics<Scalar>& physics) {
+        State<Scalar> egg;
+        egg.rect = { pos.x - half(physics.eggSize), pos.y - half(half(physics.eggSize)), physics.eggSize, physics.eggSize };
+        egg.velocity = { right ? physics.eggSpeed : -physics.eggSpeed, -physics.eggSpeed };
+        return egg;
+    }
+
+    // Returns the index of the block destroyed this tick, or -1.
+    int update(BlockField& blocks, const Board& board) {
+        return update(blocks, makePhysics<double>(board));
+    }
+
+    int update(BlockField& blocks, const Physics<double>& physics) {
+        TAPIOCA_ZONE("Egg::update");
+        return update(state, blocks, physics);
+    }
+
+    // The rules of a tick for an egg in any scalar type. blocks is a
+    // BlockField or a FixedBlockField.
+    template <class Scalar, class Field>
+    static int update(State<Scalar>& egg, Field& blocks, const Physics<Scalar>& physics) {
+        if (egg.explosionTicks >= 0) {
+            if (++egg.explosionTicks >= explosionFrames * explosionFrameTicks) {
+                egg.destroyed = true;
+            }
+            return -1;
+        }
+
+        if (egg.rect.right() <= Scalar() || egg.rect.x > physics.width) {
+            egg.explosionTicks = 0;
+            return -1;
+        }
+
+        TAPIOCA_COUNT_TESTS_AS(eggTests);
+        int hit = blocks.firstOverlapping(egg.rect);
+        // A fast egg can pass a block between two updates without ever
+        // overlapping it where it is tested. FixedWorld does not take boards
+        // that ask for this.
+        if constexpr (std::is_same<Scalar, double>::value) {
+            if (hit < 0 && egg.moved && physics.sweptCollision) {
+                hit = blocks.firstSwept(egg.rect, egg.velocity);
+            }
+        }
+        if (hit >= 0) {
+            egg.explosionTicks = 0;
+            blocks.destroy(hit);
+            return hit;
+        }
+
+        egg.velocity.y += physics.gravity;
+        egg.rect.x += egg.velocity.x;
+        egg.rect.y += egg.velocity.y;
+        egg.moved = true;
+        return -1;
+    }
+
+    bool isDestroyed() const {
+        return state.destroyed;
+    }
+
+    bool isExploding() const {
+        return state.explosionTicks >= 0;
+    }
+
+    int getExplosionFrame() const {
+        return state.explosionTicks / explosionFrameTicks;
+    }
+
+    const Rect& getRect() const {
+        return state.rect;
+    }
+
+    // Zobrist key of the egg's state.
+    std::uint64_t hash() const {
+        using namespace zobrist;
+        const auto& s = state;
+        return key(EggPos, quantize(s.rect.x), quantize(s.rect.y)) ^
+            key(EggMotion, quantize(s.velocity.x) * 4 + s.moved * 2 + s.destroyed, quantize(s.velocity.y) * 256 + s.explosionTicks);
+    }
+
+private:
+    State<double> state;
+};
+
+}
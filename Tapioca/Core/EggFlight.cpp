@@ -0,0 +1,219 @@
+#include "EggFlight.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "Block.h"
+#include "World.h"
+
+namespace tapioca {
+
+namespace {
+
+constexpr Board shipped;
+constexpr int speed = static_cast<int>(shipped.eggSpeed);
+constexpr int size = static_cast<int>(Egg::size);
+constexpr int columnWidth = static_cast<int>(shipped.width) / shipped.numBlocksX;
+
+static_assert(shipped.eggSpeed == speed && Egg::size == size && columnWidth * shipped.numBlocksX == shipped.width,
+    "the tables assume whole-pixel speeds and sizes");
+
+constexpr int floorDiv(int a, int b) {
+    return a / b - (a % b != 0 && (a < 0) != (b < 0));
+}
+
+constexpr int ceilDiv(int a, int b) {
+    return -floorDiv(-a, b);
+}
+
+// Same sums in the same order as Egg::update.
+constexpr std::array<double, EggFlight::maxTicks> makeDrops() {
+    std::array<double, EggFlight::maxTicks> drops{};
+    double y = 0.0;
+    double vy = -shipped.eggSpeed;
+    for (int n = 0; n < EggFlight::maxTicks; ++n) {
+        drops[n] = y;
+        vy += shipped.gravity;
+        y += vy;
+    }
+    return drops;
+}
+
+constexpr int exitTick(int x, bool right, int width) {
+    if (right) {
+        return x + size <= 0 ? 0 : floorDiv(width - x, speed) + 1;
+    }
+    return x > width ? 0 : ceilDiv(x + size, speed);
+}
+
+constexpr int numRanges = EggFlight::numLaunchX * 2 * EggFlight::numColumns;
+
+// An egg at x overlaps a column at cx if x < cx + columnWidth and cx < x + size.
+constexpr std::array<EggFlight::TickRange, numRanges> makeColumnTicks() {
+    std::array<EggFlight::TickRange, numRanges> ticks{};
+    const int width = static_cast<int>(shipped.width);
+    for (int x = EggFlight::minLaunchX; x < EggFlight::minLaunchX + EggFlight::numLaunchX; ++x) {
+        for (int right = 0; right < 2; ++right) {
+            const int exit = exitTick(x, right != 0, width);
+            for (int c = 0; c < EggFlight::numColumns; ++c) {
+                const int cx = c * columnWidth;
+                // Bounds on n * speed, exclusive.
+                const int above = right ? cx - size - x : x - cx - columnWidth;
+                const int below = right ? cx + columnWidth - x : x + size - cx;
+                const int first = std::max(floorDiv(above, speed) + 1, 0);
+                const int last = std::min(ceilDiv(below, speed) - 1, exit - 1);
+                auto& range = ticks[EggFlight::getRangeIndex(x, right != 0, c)];
+                range.first = static_cast<std::int8_t>(first);
+                range.last = static_cast<std::int8_t>(std::max(last, first - 1));
+            }
+        }
+    }
+    return ticks;
+}
+
+constexpr auto dropTable = makeDrops();
+constexpr auto columnTickTable = makeColumnTicks();
+static_assert(dropTable[1] == -18.5 && dropTable[2] == -35.5, "drops follow Egg::update");
+
+// Open intervals of n, at most two of them.
+struct Intervals {
+    double lo[2];
+    double hi[2];
+    int count = 0;
+
+    void add(double l, double h) {
+        if (l < h) {
+            lo[count] = l;
+            hi[count] = h;
+            ++count;
+        }
+    }
+};
+
+constexpr double infinity = std::numeric_limits<double>::infinity();
+
+// Where a * n^2 + b * n + c < 0.
+Intervals getNegative(double a, double b, double c) {
+    Intervals result;
+    if (a == 0.0) {
+        if (b == 0.0) {
+            result.add(c < 0.0 ? -infinity : 0.0, c < 0.0 ? infinity : 0.0);
+        } else if (b > 0.0) {
+            result.add(-infinity, -c / b);
+        } else {
+            result.add(-c / b, infinity);
+        }
+        return result;
+    }
+    const double disc = b * b - 4.0 * a * c;
+    if (disc <= 0.0) {
+        if (a < 0.0) {
+            result.add(-infinity, infinity);
+        }
+        return result;
+    }
+    const double root = std::sqrt(disc);
+    const double r1 = std::min((-b - root) / (2.0 * a), (-b + root) / (2.0 * a));
+    const double r2 = std::max((-b - root) / (2.0 * a), (-b + root) / (2.0 * a));
+    if (a > 0.0) {
+        result.add(r1, r2);
+    } else {
+        result.add(-infinity, r1);
+        result.add(r2, infinity);
+    }
+    return result;
+}
+
+}
+
+const std::array<double, EggFlight::maxTicks> EggFlight::drops = dropTable;
+const std::array<EggFlight::TickRange, numRanges> EggFlight::columnTicks = columnTickTable;
+
+Vec2 EggFlight::getOffset(int n, bool right, const Board& board) {
+    const double x = right ? n * board.eggSpeed : -n * board.eggSpeed;
+    if (board.gravity == shipped.gravity && n < maxTicks) {
+        return { x, drops[n] };
+    }
+    return { x, -n * board.eggSpeed + board.gravity * n * (n + 1) / 2.0 };
+}
+
+int EggFlight::getExitTick(Vec2 start, bool right, const Board& board) {
+    if (right) {
+        return start.x + Egg::size <= 0.0 ? 0 : static_cast<int>(std::floor((board.width - start.x) / board.eggSpeed)) + 1;
+    }
+    return start.x > board.width ? 0 : static_cast<int>(std::ceil((start.x + Egg::size) / board.eggSpeed));
+}
+
+int EggFlight::getHitTick(Vec2 start, bool right, const Rect& target, double fallSpeed, const Board& board) {
+    const int launchX = static_cast<int>(start.x);
+    const int column = static_cast<int>(target.x) / columnWidth;
+    if (board != shipped || launchX != start.x || launchX < minLaunchX || launchX >= minLaunchX + numLaunchX ||
+        target.x != column * columnWidth || column >= numColumns || target.w != Block::size || target.h != Block::size) {
+        return solveHitTick(start, right, target, fallSpeed, board);
+    }
+
+    const auto range = columnTicks[getRangeIndex(launchX, right, column)];
+    for (int n = range.first; n <= range.last; ++n) {
+        const double eggY = start.y + drops[n];
+        const double targetY = target.y + fallSpeed * n;
+        if (eggY < targetY + target.h && targetY < eggY + Egg::size) {
+            return n;
+        }
+    }
+    return -1;
+}
+
+int EggFlight::solveHitTick(Vec2 start, bool right, const Rect& target, double fallSpeed, const Board& board) {
+    // n from 0 until the egg leaves the board, within the target's columns.
+    double lo = -1.0;
+    double hi = getExitTick(start, right, board);
+    if (right) {
+        lo = std::max(lo, (target.x - Egg::size - start.x) / board.eggSpeed);
+        hi = std::min(hi, (target.right() - start.x) / board.eggSpeed);
+    } else {
+        lo = std::max(lo, (start.x - target.right()) / board.eggSpeed);
+        hi = std::min(hi, (start.x + Egg::size - target.x) / board.eggSpeed);
+    }
+
+    // The egg's height over the target is a * n^2 + b * n + c, which must
+    // lie strictly between -Egg::size and target.h.
+    const double a = board.gravity / 2.0;
+    const double b = board.gravity / 2.0 - board.eggSpeed - fallSpeed;
+    const double c = start.y - target.y;
+    const auto aboveBottom = getNegative(a, b, c - target.h);
+    const auto belowTop = getNegative(-a, -b, -c - Egg::size);
+
+    int best = -1;
+    for (int i = 0; i < aboveBottom.count; ++i) {
+        for (int j = 0; j < belowTop.count; ++j) {
+            const double l = std::max({ lo, aboveBottom.lo[i], belowTop.lo[j] });
+            const double h = std::min({ hi, aboveBottom.hi[i], belowTop.hi[j] });
+            const double n = std::floor(l) + 1.0;
+            if (n < h && (best < 0 || n < best)) {
+                best = static_cast<int>(n);
+            }
+        }
+    }
+    return best;
+}
+
+EggFlight::Hit EggFlight::predict(const World& world) {
+    const auto& player = world.getPlayer();
+    const auto& blocks = world.getBlocks();
+    const auto start = Egg::getStartPos(player.getRect().topCenter());
+    Hit hit;
+    for (int i = 0; i < blocks.size(); ++i) {
+        const double fallSpeed = blocks.isAsleep(i) ? 0.0 : Block::fallingSpeed;
+        auto target = blocks.getRect(i);
+        // Blocks move before the egg does in the tick it is thrown.
+        target.y += fallSpeed;
+        const int ticks = getHitTick(start, player.isFacingRight(), target, fallSpeed, world.getBoard());
+        // Ties go to the block the egg would test first.
+        if (ticks >= 0 && (hit.ticks < 0 || ticks < hit.ticks || (ticks == hit.ticks && blocks.spawnedBefore(i, hit.block)))) {
+            hit.block = i;
+            hit.ticks = ticks;
+        }
+    }
+    return hit;
+}
+
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include "Board.h"
+#include "Egg.h"
+#include "Geometry.h"
+
+namespace tapioca {
+
+class World;
+
+// Where thrown eggs go, without stepping them. An egg appears at start (its
+// top left, Egg::getStartPos) and after n updates is at
+//     start.x +- n * eggSpeed
+//     start.y - n * eggSpeed + gravity * n * (n + 1) / 2
+// Update n + 1 tests it against the blocks at that position, from n = 0 in
+// the tick it is thrown. It explodes without a hit once it is off the side
+// of the board. With Board::sweptCollision it can also hit blocks it
+// passes between two updates, which is not predicted here.
+//
+// For the shipped board the ticks are looked up in tables built at compile
+// time; other boards and launch points are solved in closed form.
+class EggFlight {
+public:
+    // More updates than any egg stays on the shipped board.
+    static constexpr int maxTicks = 32;
+    // Launch x of the tables: whole pixels from minLaunchX to the board width.
+    static constexpr int minLaunchX = -static_cast<int>(Egg::size);
+    static constexpr int numLaunchX = static_cast<int>(Board().width) - minLaunchX + 1;
+    static constexpr int numColumns = Board().numBlocksX;
+
+    // Updates in which an egg can hit blocks of one column, first to last;
+    // none if first > last.
+    struct TickRange {
+        std::int8_t first;
+        std::int8_t last;
+    };
+
+    // The block an egg would destroy and the number of updates after the
+    // first it takes; block is -1 if it hits nothing.
+    struct Hit {
+        int block = -1;
+        int ticks = -1;
+    };
+
+    // drops[n] is the y offset after n updates with the shipped gravity.
+    static const std::array<double, maxTicks> drops;
+    // Indexed by getRangeIndex().
+    static const std::array<TickRange, numLaunchX * 2 * numColumns> columnTicks;
+
+    static constexpr int getRangeIndex(int launchX, bool right, int column) {
+        return ((launchX - minLaunchX) * 2 + right) * numColumns + column;
+    }
+
+    // Offset of the egg from start after n updates.
+    static Vec2 getOffset(int n, bool right, const Board& board);
+
+    // Number of updates before the egg is off the side of the board.
+    static int getExitTick(Vec2 start, bool right, const Board& board);
+
+    // First update in which the egg overlaps target, which moves down by
+    // fallSpeed every tick after the first, or -1 if it leaves the board
+    // first. Uses the tables where they apply.
+    static int getHitTick(Vec2 start, bool right, const Rect& target, double fallSpeed, const Board& board);
+
+    // The same in closed form for any board and launch point. On a graze
+    // within rounding error it can be a tick off from the stepped egg.
+    static int solveHitTick(Vec2 start, bool right, const Rect& target, double fallSpeed, const Board& board);
+
+    // The block an egg thrown by the player in the next tick would destroy.
+    // Falling blocks are assumed to keep falling for the whole flight.
+    static Hit predict(const World& world);
+};
+
+}
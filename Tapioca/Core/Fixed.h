@@ -0,0 +1,126 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include "Geometry.h"
+
+namespace tapioca {
+
+// Signed 16.16 fixed-point number: raw / 65536. Sums and comparisons are
+// plain integer operations, so they give the same bits with every compiler
+// and floating-point setting. The range of about +-32768 px covers every
+// board the headless runners build.
+struct Fixed {
+    static constexpr int fractionBits = 16;
+    static constexpr std::int32_t one = 1 << fractionBits;
+
+    std::int32_t raw = 0;
+
+    static constexpr Fixed fromRaw(std::int32_t raw) {
+        Fixed f;
+        f.raw = raw;
+        return f;
+    }
+
+    static constexpr Fixed fromInt(int value) {
+        return fromRaw(value * one);
+    }
+
+    // Rounds to the nearest 1/65536. Scaling by a power of two is exact, so
+    // this is the only rounding a value goes through.
+    static Fixed fromDouble(double value) {
+        return fromRaw(static_cast<std::int32_t>(std::llround(value * one)));
+    }
+
+    // Exact: every Fixed is a double.
+    constexpr double toDouble() const {
+        return static_cast<double>(raw) / one;
+    }
+
+    constexpr Fixed operator+(Fixed other) const {
+        return fromRaw(raw + other.raw);
+    }
+
+    constexpr Fixed operator-(Fixed other) const {
+        return fromRaw(raw - other.raw);
+    }
+
+    constexpr Fixed operator-() const {
+        return fromRaw(-raw);
+    }
+
+    // Halves, rounding down.
+    constexpr Fixed half() const {
+        return fromRaw(raw >> 1);
+    }
+
+    Fixed& operator+=(Fixed other) {
+        raw += other.raw;
+        return *this;
+    }
+
+    Fixed& operator-=(Fixed other) {
+        raw -= other.raw;
+        return *this;
+    }
+
+    constexpr bool operator==(Fixed other) const {
+        return raw == other.raw;
+    }
+
+    constexpr bool operator!=(Fixed other) const {
+        return raw != other.raw;
+    }
+
+    constexpr bool operator<(Fixed other) const {
+        return raw < other.raw;
+    }
+
+    constexpr bool operator<=(Fixed other) const {
+        return raw <= other.raw;
+    }
+
+    constexpr bool operator>(Fixed other) const {
+        return raw > other.raw;
+    }
+
+    constexpr bool operator>=(Fixed other) const {
+        return raw >= other.raw;
+    }
+};
+
+struct FixedVec2 {
+    Fixed x, y;
+
+    Vec2 toVec2() const {
+        return { x.toDouble(), y.toDouble() };
+    }
+};
+
+// Rect in fixed point, with the same edge semantics.
+struct FixedRect {
+    Fixed x, y, w, h;
+
+    constexpr bool intersects(const FixedRect& other) const {
+        return x < other.x + other.w && other.x < x + w &&
+            y < other.y + other.h && other.y < y + h;
+    }
+
+    constexpr FixedVec2 topCenter() const {
+        return { x + w.half(), y };
+    }
+
+    constexpr Fixed right() const {
+        return x + w;
+    }
+
+    constexpr Fixed bottom() const {
+        return y + h;
+    }
+
+    Rect toRect() const {
+        return Rect(x.toDouble(), y.toDouble(), w.toDouble(), h.toDouble());
+    }
+};
+
+}
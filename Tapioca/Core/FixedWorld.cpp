@@ -0,0 +1,228 @@
+#include "FixedWorld.h"
+#include <algorithm>
+#include <stdexcept>
+#include "Egg.h"
+#include "Player.h"
+#include "SettledGrid.h"
+#include "World.h"
+
+namespace tapioca {
+
+namespace {
+
+std::int64_t floorDiv(std::int64_t a, std::int64_t b) {
+    return a / b - (a % b != 0 && (a < 0) != (b < 0));
+}
+
+class Fnv {
+public:
+    void add(std::uint64_t value) {
+        h = (h ^ value) * 1099511628211ull;
+    }
+
+    std::uint64_t get() const {
+        return h;
+    }
+
+private:
+    std::uint64_t h = 14695981039346656037ull;
+};
+
+}
+
+FixedBlockField::FixedBlockField(const Board& board, const Physics<Fixed>& physics) :
+    numBlocksX(board.numBlocksX),
+    width(physics.width),
+    floorY(physics.floorY),
+    blockSize(physics.blockSize),
+    fallingSpeed(physics.fallingSpeed) {
+    for (int c = 0; c < numBlocksX; ++c) {
+        columnXs.push_back(Fixed::fromRaw(static_cast<std::int32_t>(std::int64_t(c) * width.raw / numBlocksX)));
+    }
+    columnIndex.reset(board);
+}
+
+void FixedBlockField::spawn(int column) {
+    const int index = size();
+    ys.push_back(-blockSize);
+    columns.push_back(column);
+    flags.push_back(Block::Moving);
+    serials.push_back(nextSerial++);
+    columnIndex.add(columns, index);
+    awakeBlocks.push_back(index);
+}
+
+// As BlockField::updateStepped. Blocks come to rest on rows, and the first
+// row at or above the top of the board ends the game.
+bool FixedBlockField::update() {
+    TAPIOCA_COUNT(willCollideChecks, awakeBlocks.size());
+    for (const int i : awakeBlocks) {
+        // The block below has already been updated for this tick.
+        if (willCollide(i)) {
+            flags[i] = (flags[i] & ~Block::Moving) | Block::Asleep;
+            if (ys[i] <= Fixed()) {
+                return false;
+            }
+        } else {
+            flags[i] |= Block::Moving;
+            ys[i] += fallingSpeed;
+        }
+    }
+    awakeBlocks.erase(
+        std::remove_if(awakeBlocks.begin(), awakeBlocks.end(),
+            [this](int i) { return (flags[i] & Block::Asleep) != 0; }),
+        awakeBlocks.end());
+    return true;
+}
+
+bool FixedBlockField::willCollide(int index) const {
+    return Block::willCollide(ys[index], columnIndex.below(columns, index), ys, floorY, blockSize, fallingSpeed);
+}
+
+// As BlockField::remove: the last block moves into the place of the
+// removed one, and the blocks above the removed one fall again.
+void FixedBlockField::remove(int index) {
+    above.clear();
+    columnIndex.forEachAbove(columns, index, [&](int i) {
+        above.push_back(i);
+    });
+    const int last = size() - 1;
+    const auto removed = std::find(awakeBlocks.begin(), awakeBlocks.end(), index);
+    if (removed != awakeBlocks.end()) {
+        awakeBlocks.erase(removed);
+    }
+    std::replace(awakeBlocks.begin(), awakeBlocks.end(), last, index);
+    columnIndex.remove(columns, index);
+    swapRemove(index, ys, columns, flags, serials);
+
+    for (int i : above) {
+        if (i == last) {
+            i = index;
+        }
+        if (flags[i] & Block::Asleep) {
+            flags[i] &= ~Block::Asleep;
+            wake(i);
+        }
+    }
+}
+
+void FixedBlockField::wake(int index) {
+    const auto it = std::lower_bound(awakeBlocks.begin(), awakeBlocks.end(), index,
+        [this](int a, int b) { return spawnedBefore(a, b); });
+    awakeBlocks.insert(it, index);
+}
+
+// Columns whose blocks may intersect rect; column c starts at
+// floor(c * width / numBlocksX).
+std::pair<int, int> FixedBlockField::getColumnRange(const FixedRect& rect) const {
+    const std::int64_t n = numBlocksX;
+    return {
+        static_cast<int>(std::max<std::int64_t>(0, floorDiv((rect.x - blockSize).raw * n, width.raw))),
+        static_cast<int>(std::min<std::int64_t>(n - 1, floorDiv(rect.right().raw * n, width.raw)))
+    };
+}
+
+int FixedBlockField::firstOverlapping(const FixedRect& rect) const {
+    int first = -1;
+    forEachOverlapping(rect, [&](int index) {
+        if (first < 0 || spawnedBefore(index, first)) {
+            first = index;
+        }
+        return false;
+    });
+    return first;
+}
+
+FixedWorld::FixedWorld(const Board& board, std::uint64_t seed) :
+    board(board),
+    physics(makePhysics<Fixed>(board)),
+    height(Fixed::fromDouble(board.height)),
+    blocks(board, physics),
+    rng(seed),
+    blockSpawnInterval(World::defaultBlockSpawnInterval) {
+    if (board.sweptCollision) {
+        throw std::invalid_argument("FixedWorld does not support swept collision");
+    }
+    if (board.numBlocksX > SettledGrid::maxColumns) {
+        throw std::invalid_argument("FixedWorld supports at most 64 columns");
+    }
+
+    const auto playerWidth = Fixed::fromDouble(tapioca::Player::width);
+    const auto playerHeight = Fixed::fromDouble(tapioca::Player::height);
+    player.rect = { Fixed::fromInt(100), physics.floorY - playerHeight, playerWidth, playerHeight };
+}
+
+void FixedWorld::step(const Input& input) {
+    if (gameOver) {
+        return;
+    }
+    ++tick;
+
+    if (blockSpawnInterval > 0 && ++spawnTicks >= blockSpawnInterval) {
+        spawnBlock(static_cast<int>(rng.below(board.numBlocksX)));
+        spawnTicks = 0;
+    }
+    if (!blocks.update()) {
+        gameOver = true;
+        return;
+    }
+
+    const int hit = updatePlayer(input);
+    if (hit >= 0) {
+        // 100 times the height of the block over the board, rounded towards zero.
+        score += static_cast<int>(std::int64_t(100) * (height - blocks.getPosY(hit)).raw / height.raw);
+        blocks.remove(hit);
+        ++blocksDestroyed;
+    }
+    if (player.dead) {
+        gameOver = true;
+    }
+}
+
+void FixedWorld::spawnBlock(int column) {
+    blocks.spawn(column);
+}
+
+std::uint64_t FixedWorld::hash() const {
+    Fnv fnv;
+    fnv.add(tick);
+    fnv.add(static_cast<std::uint64_t>(spawnTicks) << 32 | static_cast<std::uint32_t>(score));
+    fnv.add(static_cast<std::uint64_t>(blocksDestroyed) << 1 | gameOver);
+    fnv.add(rng.hash());
+    const auto rawPair = [](Fixed a, Fixed b) {
+        return static_cast<std::uint64_t>(static_cast<std::uint32_t>(a.raw)) << 32 | static_cast<std::uint32_t>(b.raw);
+    };
+    fnv.add(rawPair(player.rect.x, player.rect.y));
+    fnv.add(rawPair(player.vy, Fixed::fromRaw(player.eggCooldown << 8 | player.throwingTicksLeft)));
+    fnv.add(player.grounded | player.facingRight << 1 | player.dead << 2);
+    if (player.egg) {
+        const auto& egg = *player.egg;
+        fnv.add(rawPair(egg.rect.x, egg.rect.y));
+        fnv.add(rawPair(egg.velocity.x, egg.velocity.y));
+        fnv.add(static_cast<std::uint64_t>(egg.explosionTicks) << 1 | egg.destroyed);
+    }
+    for (int i = 0; i < getNumBlocks(); ++i) {
+        fnv.add(static_cast<std::uint64_t>(static_cast<std::uint32_t>(blocks.getPosY(i).raw)) << 32 |
+            blocks.getColumn(i) << 8 | blocks.getFlags(i));
+    }
+    return fnv.get();
+}
+
+// As tapioca::Player::update.
+int FixedWorld::updatePlayer(const Input& input) {
+    if (tapioca::Player::updateThrow(player, input)) {
+        player.egg = tapioca::Egg::launch(player.rect.topCenter(), player.facingRight, physics);
+    }
+    int hit = -1;
+    if (player.egg) {
+        hit = tapioca::Egg::update(*player.egg, blocks, physics);
+        if (player.egg->destroyed) {
+            player.egg.reset();
+        }
+    }
+    TAPIOCA_COUNT_TESTS_AS(playerTests);
+    tapioca::Player::move(player, input, blocks, physics);
+    return hit;
+}
+
+}
@@ -0,0 +1,200 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+#include "Block.h"
+#include "Board.h"
+#include "ColumnIndex.h"
+#include "Counters.h"
+#include "Egg.h"
+#include "Fixed.h"
+#include "Input.h"
+#include "Physics.h"
+#include "Player.h"
+#include "Random.h"
+#include "SlotTable.h"
+
+namespace tapioca {
+
+// FixedWorld's blocks: BlockField in stepped mode, in fixed point, with the
+// same block order and the same queries for the rules of Player and Egg.
+class FixedBlockField {
+public:
+    FixedBlockField(const Board& board, const Physics<Fixed>& physics);
+
+    // Drops a new block into the given column.
+    void spawn(int column);
+
+    // Advances every block by a tick. Returns false if a block came to rest
+    // at or above the top of the board.
+    bool update();
+
+    // Marks a block as hit. It keeps colliding until remove() is called.
+    void destroy(int index) {
+        flags[index] |= Block::Destroyed;
+    }
+
+    // Removes a block and sets the blocks above it falling.
+    void remove(int index);
+
+    // The earliest spawned block intersecting rect, or -1, as BlockField::firstOverlapping.
+    int firstOverlapping(const FixedRect& rect) const;
+
+    // As BlockField::forEachOverlapping.
+    template <class F>
+    bool forEachOverlapping(const FixedRect& rect, F f) const {
+        std::uint64_t tests = 0;
+        const bool found = columnIndex.forEachOverlapping(getColumnRange(rect), rect,
+            [this](int index) { return getRect(index); }, f, tests);
+        TAPIOCA_COUNT(collisionTests, tests);
+        return found;
+    }
+
+    int size() const {
+        return static_cast<int>(ys.size());
+    }
+
+    Fixed getPosY(int index) const {
+        return ys[index];
+    }
+
+    int getColumn(int index) const {
+        return columns[index];
+    }
+
+    std::uint8_t getFlags(int index) const {
+        return flags[index];
+    }
+
+    bool isMoving(int index) const {
+        return (flags[index] & Block::Moving) != 0;
+    }
+
+    bool spawnedBefore(int a, int b) const {
+        return serials[a] < serials[b];
+    }
+
+    FixedRect getRect(int index) const {
+        return { columnXs[columns[index]], ys[index], blockSize, blockSize };
+    }
+
+private:
+    int numBlocksX;
+    Fixed width;
+    Fixed floorY;
+    Fixed blockSize;
+    Fixed fallingSpeed;
+    std::vector<Fixed> columnXs;
+    // Per-block state, indexed like BlockField's.
+    std::vector<Fixed> ys;
+    std::vector<int> columns;
+    std::vector<std::uint8_t> flags;
+    std::vector<std::uint32_t> serials;
+    std::uint32_t nextSerial = 0;
+    ColumnIndex columnIndex;
+    // Indices of blocks that are not asleep, in spawn order.
+    std::vector<int> awakeBlocks;
+    // Reused by remove().
+    std::vector<int> above;
+
+    std::pair<int, int> getColumnRange(const FixedRect& rect) const;
+    bool willCollide(int index) const;
+    void wake(int index);
+};
+
+// The game of World played in 16.16 fixed point, with blocks stepped every
+// tick as in FallingMode::Stepped. The board's values are rounded to Fixed
+// once on construction; from then on a tick is integer arithmetic only, so
+// a seed and a sequence of inputs give the same bits on every compiler,
+// platform and floating-point setting. The player and the egg follow the
+// same rule templates of Player and Egg as World, instantiated for Fixed.
+//
+// Where every value of the board is a whole multiple of 1/65536, which
+// includes the shipped board, the double arithmetic of World is exact too
+// and both play the same game tick for tick.
+class FixedWorld {
+public:
+    using Egg = tapioca::Egg::State<Fixed>;
+
+    struct Player : tapioca::Player::State<Fixed> {
+        std::optional<Egg> egg;
+    };
+
+    // Throws std::invalid_argument for boards with swept collision, which
+    // the fixed-point path does not implement, and for boards wider than
+    // SettledGrid::maxColumns.
+    explicit FixedWorld(const Board& board = Board(), std::uint64_t seed = Random::makeSeed());
+
+    void step(const Input& input);
+
+    // Drops a new block into the given column, as the spawner does every blockSpawnInterval ticks.
+    void spawnBlock(int column);
+
+    // Ticks between two blocks dropped by the world itself; 0 disables the spawner.
+    void setBlockSpawnInterval(int ticks) {
+        blockSpawnInterval = ticks;
+    }
+
+    bool isGameOver() const {
+        return gameOver;
+    }
+
+    int getScore() const {
+        return score;
+    }
+
+    int getBlocksDestroyed() const {
+        return blocksDestroyed;
+    }
+
+    std::uint64_t getTick() const {
+        return tick;
+    }
+
+    const Player& getPlayer() const {
+        return player;
+    }
+
+    // Blocks in the same order as World's BlockField.
+    int getNumBlocks() const {
+        return blocks.size();
+    }
+
+    Fixed getBlockY(int index) const {
+        return blocks.getPosY(index);
+    }
+
+    int getBlockColumn(int index) const {
+        return blocks.getColumn(index);
+    }
+
+    bool isBlockMoving(int index) const {
+        return blocks.isMoving(index);
+    }
+
+    // FNV-1a over the whole state, for comparing runs across builds.
+    std::uint64_t hash() const;
+
+private:
+    Board board;
+    // The board and the game's constants in fixed point.
+    Physics<Fixed> physics;
+    Fixed height;
+
+    Player player;
+    FixedBlockField blocks;
+
+    Random rng;
+    std::uint64_t tick = 0;
+    int blockSpawnInterval;
+    int spawnTicks = 0;
+    int score = 0;
+    int blocksDestroyed = 0;
+    bool gameOver = false;
+
+    int updatePlayer(const Input& input);
+};
+
+}
@@ -0,0 +1,68 @@
+#include "FrameStats.h"
+#include <algorithm>
+
+namespace tapioca {
+
+const double FrameStats::bucketSeconds = 0.0001;
+
+void FrameStats::add(const Frame& frame) {
+    if (count == window) {
+        const auto& old = frames[next];
+        --buckets[frameBuckets[next]];
+        sum.seconds -= old.seconds;
+        sum.updateSeconds -= old.updateSeconds;
+        sum.drawSeconds -= old.drawSeconds;
+        sum.collisionTests -= old.collisionTests;
+        sum.allocations -= old.allocations;
+    } else {
+        ++count;
+    }
+
+    const auto bucket = static_cast<int>(std::min(frame.seconds / bucketSeconds, numBuckets - 1.0));
+    ++buckets[bucket];
+    frameBuckets[next] = static_cast<std::uint16_t>(bucket);
+    frames[next] = frame;
+    sum.seconds += frame.seconds;
+    sum.updateSeconds += frame.updateSeconds;
+    sum.drawSeconds += frame.drawSeconds;
+    sum.collisionTests += frame.collisionTests;
+    sum.allocations += frame.allocations;
+    next = (next + 1) % window;
+}
+
+void FrameStats::clear() {
+    buckets.fill(0);
+    sum = Frame();
+    next = 0;
+    count = 0;
+}
+
+double FrameStats::getPercentile(double p) const {
+    if (count == 0) {
+        return 0.0;
+    }
+    const auto rank = std::max(1, static_cast<int>(p * count + 0.5));
+    int seen = 0;
+    for (int b = 0; b < numBuckets; ++b) {
+        seen += buckets[b];
+        if (seen >= rank) {
+            return (b + 1) * bucketSeconds;
+        }
+    }
+    return numBuckets * bucketSeconds;
+}
+
+FrameStats::Frame FrameStats::getMean() const {
+    Frame mean;
+    if (count == 0) {
+        return mean;
+    }
+    mean.seconds = sum.seconds / count;
+    mean.updateSeconds = sum.updateSeconds / count;
+    mean.drawSeconds = sum.drawSeconds / count;
+    mean.collisionTests = (sum.collisionTests + count / 2) / count;
+    mean.allocations = (sum.allocations + count / 2) / count;
+    return mean;
+}
+
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+namespace tapioca {
+
+// Statistics over the last frames of the game for the performance overlay.
+// Frame times are counted in a histogram of fixed-width buckets and the
+// other values summed as frames enter and leave the window, so adding a
+// frame takes constant time and never allocates.
+class FrameStats {
+public:
+    static constexpr int window = 600;
+    static constexpr int numBuckets = 1000;
+    // Frames slower than numBuckets buckets count as the last bucket.
+    static const double bucketSeconds;
+
+    struct Frame {
+        // From the start of the previous frame.
+        double seconds = 0.0;
+        double updateSeconds = 0.0;
+        double drawSeconds = 0.0;
+        std::uint64_t collisionTests = 0;
+        std::uint64_t allocations = 0;
+    };
+
+    void add(const Frame& frame);
+
+    void clear();
+
+    int size() const {
+        return count;
+    }
+
+    // Frame time below which a fraction p of the frames in the window fall,
+    // rounded up to a bucket edge; 0 with no frames.
+    double getPercentile(double p) const;
+
+    // Means over the window, counts rounded to the nearest whole number.
+    Frame getMean() const;
+
+private:
+    std::array<std::uint16_t, numBuckets> buckets{};
+    std::array<Frame, window> frames;
+    std::array<std::uint16_t, window> frameBuckets{};
+    Frame sum;
+    int next = 0;
+    int count = 0;
+};
+
+}
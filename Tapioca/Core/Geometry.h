@@ -0,0 +1,94 @@
+#pragma once
+
+#include <algorithm>
+#include <limits>
+
+namespace tapioca {
+
+struct Vec2 {
+    double x = 0.0, y = 0.0;
+
+    constexpr Vec2() = default;
+    constexpr Vec2(double x, double y) : x(x), y(y) {}
+
+    constexpr Vec2 operator+(Vec2 other) const {
+        return { x + other.x, y + other.y };
+    }
+
+    constexpr Vec2 operator-(Vec2 other) const {
+        return { x - other.x, y - other.y };
+    }
+
+    Vec2& operator+=(Vec2 other) {
+        x += other.x;
+        y += other.y;
+        return *this;
+    }
+};
+
+// Axis-aligned rectangle with the same edge semantics as Siv3D's RectF:
+// rectangles that merely share an edge do not intersect.
+struct Rect {
+    double x = 0.0, y = 0.0, w = 0.0, h = 0.0;
+
+    constexpr Rect() = default;
+    constexpr Rect(double x, double y, double w, double h) : x(x), y(y), w(w), h(h) {}
+    constexpr Rect(Vec2 pos, double w, double h) : x(pos.x), y(pos.y), w(w), h(h) {}
+
+    constexpr bool intersects(const Rect& other) const {
+        return x < other.x + other.w && other.x < x + w &&
+            y < other.y + other.h && other.y < y + h;
+    }
+
+    constexpr Vec2 pos() const {
+        return { x, y };
+    }
+
+    constexpr Vec2 topCenter() const {
+        return { x + w / 2.0, y };
+    }
+
+    constexpr Vec2 bottomCenter() const {
+        return { x + w / 2.0, y + h };
+    }
+
+    constexpr double right() const {
+        return x + w;
+    }
+
+    constexpr double bottom() const {
+        return y + h;
+    }
+};
+
+// Swept AABB test: moving rect by delta, returns the fraction of the move
+// after which it intersects other, 0 if it already does, or -1 if it never
+// does during the move. Touching edges do not count, as with intersects().
+inline double sweep(const Rect& rect, Vec2 delta, const Rect& other) {
+    constexpr double infinity = std::numeric_limits<double>::infinity();
+    // The open interval of fractions in which the two overlap along one axis.
+    const auto overlap = [&](double pos, double size, double move, double otherPos, double otherSize,
+                             double& enter, double& exit) {
+        if (move == 0.0) {
+            const bool inside = pos < otherPos + otherSize && otherPos < pos + size;
+            enter = inside ? -infinity : infinity;
+            exit = inside ? infinity : -infinity;
+        } else {
+            const double a = (otherPos - size - pos) / move;
+            const double b = (otherPos + otherSize - pos) / move;
+            enter = std::min(a, b);
+            exit = std::max(a, b);
+        }
+    };
+    double enterX, exitX, enterY, exitY;
+    overlap(rect.x, rect.w, delta.x, other.x, other.w, enterX, exitX);
+    overlap(rect.y, rect.h, delta.y, other.y, other.h, enterY, exitY);
+    const double enter = std::max(enterX, enterY);
+    const double exit = std::min(exitX, exitY);
+    if (enter >= exit || enter >= 1.0 || exit <= 0.0) {
+        return -1.0;
+    }
+    return std::max(enter, 0.0);
+}
+
+}
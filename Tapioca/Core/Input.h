@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstdint>
+
+namespace tapioca {
+
+// Buttons held during a single tick.
+struct Input {
+    bool left = false;
+    bool right = false;
+    bool jump = false;
+    bool throwEgg = false;
+
+    // Packs the buttons into the low four bits, as stored in replays.
+    constexpr std::uint8_t toBits() const {
+        return static_cast<std::uint8_t>(left | right << 1 | jump << 2 | throwEgg << 3);
+    }
+
+    static constexpr Input fromBits(std::uint8_t bits) {
+        return { (bits & 1) != 0, (bits & 2) != 0, (bits & 4) != 0, (bits & 8) != 0 };
+    }
+};
+
+}
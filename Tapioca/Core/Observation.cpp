@@ -0,0 +1,38 @@
+#include "Observation.h"
+
+namespace tapioca {
+
+void ObservationEncoder::encode(const World& world, float* out) const {
+    const auto& blocks = world.getBlocks();
+    const auto& grid = blocks.getSettledGrid();
+    const int n = board.numBlocksX;
+    const auto x = [&](double value) { return static_cast<float>(value / board.width); };
+    const auto y = [&](double value) { return static_cast<float>(value / board.height); };
+
+    for (int c = 0; c < n; ++c) {
+        out[c] = static_cast<float>(grid.getColumnHeight(c)) / grid.getNumRows();
+        // Settled blocks form the bottom of a column and falling ones the rest.
+        out[n + c] = -1.0f;
+        for (const int i : blocks.getColumnIndex().getColumn(c)) {
+            if (blocks.isMoving(i)) {
+                out[n + c] = y(blocks.getPosY(i));
+                break;
+            }
+        }
+    }
+
+    const auto& player = world.getPlayer();
+    float* p = out + 2 * n;
+    p[0] = x(player.getRect().x);
+    p[1] = y(player.getRect().y);
+    p[2] = y(player.getVelocityY() * ticksPerSecond);
+    p[3] = player.isFacingRight() ? 1.0f : 0.0f;
+    const auto& egg = player.getEgg();
+    p[4] = egg && !egg->isExploding() ? 1.0f : 0.0f;
+    p[5] = egg && egg->isExploding() ? 1.0f : 0.0f;
+    p[6] = egg ? x(egg->getRect().x) : 0.0f;
+    p[7] = egg ? y(egg->getRect().y) : 0.0f;
+    p[8] = static_cast<float>(player.getEggCooldown()) / Player::eggLaunchInterval;
+}
+
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "Board.h"
+#include "World.h"
+
+namespace tapioca {
+
+// Writes a fixed-size view of a World for agents into a caller-provided
+// float buffer, without allocating. Positions are scaled by the board size
+// and velocities by the board height per second. The layout is
+//
+//   [0, n)      settled stack height of each column, in rows / number of rows
+//   [n, 2n)     y of the lowest falling block of each column, -1 if none
+//   2n + 0..3   player x, y, vertical velocity, 1 if facing right
+//   2n + 4..7   1 if an egg is flying, 1 if it is exploding, egg x, egg y
+//   2n + 8      egg cooldown as a fraction of Player::eggLaunchInterval
+//
+// where n is board.numBlocksX. Only the lowest falling block of a column is
+// encoded; falling blocks stacked above it are left out.
+class ObservationEncoder {
+public:
+    explicit ObservationEncoder(const Board& board) : board(board) {}
+
+    // Number of floats encode() writes.
+    int size() const {
+        return 2 * board.numBlocksX + 9;
+    }
+
+    void encode(const World& world, float* out) const;
+
+private:
+    Board board;
+};
+
+}
@@ -0,0 +1,41 @@
+#include "Physics.h"
+#include "Block.h"
+#include "Egg.h"
+#include "Player.h"
+
+namespace tapioca {
+
+namespace {
+
+double toScalar(double value, double) {
+    return value;
+}
+
+Fixed toScalar(double value, Fixed) {
+    return Fixed::fromDouble(value);
+}
+
+}
+
+template <class Scalar>
+Physics<Scalar> makePhysics(const Board& board) {
+    const auto to = [](double value) { return toScalar(value, Scalar()); };
+    Physics<Scalar> physics;
+    physics.width = to(board.width);
+    // The difference of the rounded values, as the board's floorY() is of the exact ones.
+    physics.floorY = to(board.height) - to(board.floorHeight);
+    physics.gravity = to(board.gravity);
+    physics.eggSpeed = to(board.eggSpeed);
+    physics.eggSize = to(Egg::size);
+    physics.playerSpeed = to(Player::speed);
+    physics.jumpSpeed = to(Player::jumpSpeed);
+    physics.blockSize = to(Block::size);
+    physics.fallingSpeed = to(Block::fallingSpeed);
+    physics.sweptCollision = board.sweptCollision;
+    return physics;
+}
+
+template Physics<double> makePhysics(const Board& board);
+template Physics<Fixed> makePhysics(const Board& board);
+
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "Board.h"
+#include "Fixed.h"
+#include "Geometry.h"
+
+namespace tapioca {
+
+// The rect and vector types of a scalar type: Rect and Vec2 for double,
+// FixedRect and FixedVec2 for Fixed.
+template <class Scalar>
+struct Shapes;
+
+template <>
+struct Shapes<double> {
+    using Rect = tapioca::Rect;
+    using Vec2 = tapioca::Vec2;
+};
+
+template <>
+struct Shapes<Fixed> {
+    using Rect = FixedRect;
+    using Vec2 = FixedVec2;
+};
+
+inline double half(double value) {
+    return value / 2.0;
+}
+
+inline Fixed half(Fixed value) {
+    return value.half();
+}
+
+// The board and the game's constants in the scalar type a game is played
+// in, for the rules of Player, Egg and the blocks, which are written once
+// for the doubles of World and the fixed point of FixedWorld.
+template <class Scalar>
+struct Physics {
+    Scalar width;
+    Scalar floorY;
+    Scalar gravity;
+    Scalar eggSpeed;
+    Scalar eggSize;
+    Scalar playerSpeed;
+    Scalar jumpSpeed;
+    Scalar blockSize;
+    Scalar fallingSpeed;
+    bool sweptCollision;
+};
+
+// Rounds every value to Scalar once. Defined for double and Fixed.
+template <class Scalar>
+Physics<Scalar> makePhysics(const Board& board);
+
+}
@@ -0,0 +1,12 @@
+#include "Player.h"
+
+namespace tapioca {
+
+const double Player::width = 40.0;
+const double Player::height = 70.0;
+const int Player::eggLaunchInterval = secondsToTicks(0.5);
+const int Player::throwingTicks = secondsToTicks(0.2);
+const double Player::speed = 8;
+const double Player::jumpSpeed = 20.0;
+
+}
@@ -0,0 +1,197 @@
+#pragma once
+
+#include <algorithm>
+#include <optional>
+#include "BlockField.h"
+#include "Board.h"
+#include "Egg.h"
+#include "Geometry.h"
+#include "Counters.h"
+#include "Input.h"
+#include "Physics.h"
+#include "Profiler.h"
+#include "Zobrist.h"
+
+namespace tapioca {
+
+class Player {
+public:
+    static const double width;
+    static const double height;
+    static const double speed;
+    static const double jumpSpeed;
+    static const int eggLaunchInterval;
+    static const int throwingTicks;
+
+    // The state of a player, egg aside, in double for World or in Fixed for
+    // FixedWorld.
+    template <class Scalar>
+    struct State {
+        typename Shapes<Scalar>::Rect rect;
+        Scalar vy = Scalar();
+        bool grounded = false;
+        bool facingRight = true;
+        bool dead = false;
+        int eggCooldown = 0;
+        int throwingTicksLeft = 0;
+    };
+
+    Player(const Board& board) {
+        state.rect = Rect(100, board.floorY() - height, width, height);
+    }
+
+    // Returns the index of the block destroyed by the egg this tick, or -1.
+    int update(const Input& input, BlockField& blocks, const Board& board) {
+        TAPIOCA_ZONE("Player::update");
+        const auto physics = makePhysics<double>(board);
+        if (updateThrow(state, input)) {
+            egg = Egg(Egg::launch(state.rect.topCenter(), state.facingRight, physics));
+        }
+        int hit = -1;
+        if (egg) {
+            hit = egg->update(blocks, physics);
+            if (egg->isDestroyed()) {
+                egg.reset();
+            }
+        }
+        TAPIOCA_COUNT_TESTS_AS(playerTests);
+        move(state, input, blocks, physics);
+        return hit;
+    }
+
+    // Counts down the cooldowns and returns whether the player throws an egg
+    // this tick, which the caller launches before updating the egg.
+    template <class Scalar>
+    static bool updateThrow(State<Scalar>& p, const Input& input) {
+        if (p.eggCooldown > 0) {
+            --p.eggCooldown;
+        }
+        if (p.throwingTicksLeft > 0) {
+            --p.throwingTicksLeft;
+        }
+        if (!input.throwEgg || p.eggCooldown != 0) {
+            return false;
+        }
+        p.throwingTicksLeft = throwingTicks;
+        p.eggCooldown = eggLaunchInterval;
+        return true;
+    }
+
+    // The rules of a tick for a player's movement in any scalar type:
+    // walking unless a block is in the way, jumping, landing on blocks and
+    // the floor, and being crushed. blocks is a BlockField or a
+    // FixedBlockField.
+    template <class Scalar, class Field>
+    static void move(State<Scalar>& p, const Input& input, const Field& blocks, const Physics<Scalar>& physics) {
+        if (input.left ^ input.right) {
+            p.facingRight = input.right;
+
+            const bool left = input.left && p.rect.x > Scalar();
+            const bool right = input.right && p.rect.right() < physics.width;
+            if (left ^ right) {
+                auto vx = left ? -physics.playerSpeed : physics.playerSpeed;
+                auto nextRect = p.rect;
+                nextRect.x += vx;
+                if (blocks.firstOverlapping(nextRect) >= 0) {
+                    vx = Scalar();
+                }
+                p.rect.x += vx;
+            }
+        }
+
+        if (p.grounded && input.jump) {
+            p.vy = -physics.jumpSpeed;
+            p.grounded = false;
+        }
+
+        p.vy += physics.gravity;
+        bool touching = false;
+        auto nextRect = p.rect;
+        nextRect.y += p.vy;
+        const int support = blocks.firstOverlapping(nextRect);
+        if (support >= 0) {
+            if (blocks.isMoving(support)) {
+                if (p.vy > Scalar()) {
+                    p.grounded = touching = true;
+                }
+                p.vy = physics.fallingSpeed;
+            } else {
+                p.grounded = touching = true;
+                p.vy = Scalar();
+            }
+        }
+
+        if (!touching && p.rect.bottom() + p.vy > physics.floorY) {
+            p.grounded = true;
+            p.vy = Scalar();
+        }
+
+        p.rect.y += p.vy;
+
+        if (p.grounded && blocks.forEachOverlapping(p.rect, [&](int i) {
+                return blocks.isMoving(i) && blocks.getPosY(i) < p.rect.y;
+            })) {
+            p.dead = true;
+        }
+    }
+
+    // Advances the cooldowns of a resting player with no buttons held, which
+    // is all a tick would do to it.
+    void rest(int ticks) {
+        state.eggCooldown = std::max(0, state.eggCooldown - ticks);
+        state.throwingTicksLeft = std::max(0, state.throwingTicksLeft - ticks);
+    }
+
+    // Standing still on the floor or a settled block with no egg in flight.
+    bool isResting() const {
+        return state.grounded && state.vy == 0.0 && !egg && !state.dead;
+    }
+
+    bool isDead() const {
+        return state.dead;
+    }
+
+    bool isFacingRight() const {
+        return state.facingRight;
+    }
+
+    bool isThrowing() const {
+        return state.throwingTicksLeft > 0;
+    }
+
+    const Rect& getRect() const {
+        return state.rect;
+    }
+
+    double getVelocityY() const {
+        return state.vy;
+    }
+
+    // Ticks until the next egg can be thrown.
+    int getEggCooldown() const {
+        return state.eggCooldown;
+    }
+
+    const std::optional<Egg>& getEgg() const {
+        return egg;
+    }
+
+    // Zobrist key of the player's state, egg included, quantized as
+    // zobrist::quantize does.
+    std::uint64_t hash() const {
+        using namespace zobrist;
+        const auto& s = state;
+        const std::int64_t flags = s.grounded | s.facingRight << 1 | s.dead << 2 | s.eggCooldown << 3;
+        auto h = key(PlayerPos, quantize(s.rect.x), quantize(s.rect.y)) ^
+            key(PlayerMotion, quantize(s.vy), flags << 16 | s.throwingTicksLeft);
+        return egg ? h ^ egg->hash() : h;
+    }
+
+private:
+    State<double> state;
+    // The egg in flight or exploding. A player has at most one, so it is
+    // kept in place: throwing reuses this storage and allocates nothing.
+    std::optional<Egg> egg;
+};
+
+}
@@ -0,0 +1,117 @@
+#include "Profiler.h"
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+
+namespace tapioca {
+
+namespace {
+
+struct Ring {
+    std::vector<Profiler::Event> events = std::vector<Profiler::Event>(Profiler::ringSize);
+    // Zones ever recorded; the ring holds the last ringSize of them.
+    std::uint64_t count = 0;
+    int thread = 0;
+};
+
+const auto epoch = std::chrono::steady_clock::now();
+
+// Rings outlive their threads, so zones of finished workers can still be dumped.
+std::mutex ringsMutex;
+std::vector<std::unique_ptr<Ring>> rings;
+thread_local Ring* threadRing = nullptr;
+
+Ring& getRing() {
+    if (!threadRing) {
+        std::lock_guard<std::mutex> lock(ringsMutex);
+        rings.push_back(std::make_unique<Ring>());
+        rings.back()->thread = static_cast<int>(rings.size()) - 1;
+        threadRing = rings.back().get();
+    }
+    return *threadRing;
+}
+
+void writeString(std::ostream& out, const char* s) {
+    out << '"';
+    for (; *s; ++s) {
+        if (*s == '"' || *s == '\\') {
+            out << '\\';
+        }
+        out << *s;
+    }
+    out << '"';
+}
+
+}
+
+std::uint64_t Profiler::now() {
+    return static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count());
+}
+
+void Profiler::record(const char* name, std::uint64_t start, std::uint64_t end) {
+    auto& ring = getRing();
+    ring.events[ring.count++ & (ringSize - 1)] = { name, start, end - start, ring.thread };
+}
+
+std::vector<Profiler::Event> Profiler::collect() {
+    std::lock_guard<std::mutex> lock(ringsMutex);
+    std::vector<Event> events;
+    for (const auto& ring : rings) {
+        const auto first = ring->count > ringSize ? ring->count - ringSize : 0;
+        for (auto i = first; i < ring->count; ++i) {
+            events.push_back(ring->events[i & (ringSize - 1)]);
+        }
+    }
+    return events;
+}
+
+void Profiler::clear() {
+    std::lock_guard<std::mutex> lock(ringsMutex);
+    for (auto& ring : rings) {
+        ring->count = 0;
+    }
+}
+
+// Complete ("X") events in microseconds, plus a name for every thread.
+void Profiler::writeChromeTrace(std::ostream& out) {
+    const auto events = collect();
+    int numThreads = 0;
+    {
+        std::lock_guard<std::mutex> lock(ringsMutex);
+        numThreads = static_cast<int>(rings.size());
+    }
+
+    const auto flags = out.flags();
+    out.setf(std::ios::fixed);
+    out.precision(3);
+    out << "{\"traceEvents\":[\n";
+    bool first = true;
+    for (int t = 0; t < numThreads; ++t) {
+        out << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << t
+            << ",\"args\":{\"name\":\"thread " << t << "\"}}";
+        first = false;
+    }
+    for (const auto& event : events) {
+        out << (first ? "" : ",\n") << "{\"name\":";
+        writeString(out, event.name);
+        out << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << event.thread << ",\"ts\":" << event.start / 1000.0
+            << ",\"dur\":" << event.duration / 1000.0 << '}';
+        first = false;
+    }
+    out << "\n]}\n";
+    out.flags(flags);
+}
+
+bool Profiler::writeChromeTrace(const std::string& path) {
+    std::ofstream file(path);
+    if (!file) {
+        return false;
+    }
+    writeChromeTrace(file);
+    return static_cast<bool>(file);
+}
+
+}
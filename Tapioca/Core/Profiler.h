@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace tapioca {
+
+// Scoped timing zones for finding where a tick or a frame goes.
+// TAPIOCA_ZONE("name") times the rest of the enclosing block. Every thread
+// records its zones into a ring of its own, without locking, and
+// writeChromeTrace() dumps the rings as Chrome trace JSON for
+// chrome://tracing or Perfetto.
+//
+// Zones are only compiled in with TAPIOCA_PROFILE defined, which the CMake
+// option of the same name does; otherwise TAPIOCA_ZONE expands to nothing.
+class Profiler {
+public:
+#ifdef TAPIOCA_PROFILE
+    static constexpr bool enabled = true;
+#else
+    static constexpr bool enabled = false;
+#endif
+    // Zones kept per thread; older ones are overwritten.
+    static constexpr std::size_t ringSize = std::size_t(1) << 15;
+
+    struct Event {
+        // A string literal.
+        const char* name;
+        // Nanoseconds since the program started.
+        std::uint64_t start;
+        std::uint64_t duration;
+        // Numbered in the order threads first record a zone.
+        int thread;
+    };
+
+    static std::uint64_t now();
+
+    static void record(const char* name, std::uint64_t start, std::uint64_t end);
+
+    // The zones in the rings, oldest first per thread. Like clear() and
+    // writeChromeTrace(), to be called while no other thread is recording.
+    static std::vector<Event> collect();
+
+    static void clear();
+
+    static void writeChromeTrace(std::ostream& out);
+
+    // Returns false if the file could not be written.
+    static bool writeChromeTrace(const std::string& path);
+};
+
+class ProfileZone {
+public:
+    explicit ProfileZone(const char* name) : name(name), start(Profiler::now()) {}
+
+    ~ProfileZone() {
+        Profiler::record(name, start, Profiler::now());
+    }
+
+    ProfileZone(const ProfileZone&) = delete;
+    ProfileZone& operator=(const ProfileZone&) = delete;
+
+private:
+    const char* name;
+    std::uint64_t start;
+};
+
+}
+
+#ifdef TAPIOCA_PROFILE
+#define TAPIOCA_ZONE_JOIN2(a, b) a##b
+#define TAPIOCA_ZONE_JOIN(a, b) TAPIOCA_ZONE_JOIN2(a, b)
+#define TAPIOCA_ZONE(name) const ::tapioca::ProfileZone TAPIOCA_ZONE_JOIN(profileZone, __LINE__)(name)
+#else
+#define TAPIOCA_ZONE(name) static_cast<void>(0)
+#endif
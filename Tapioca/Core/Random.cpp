@@ -0,0 +1,11 @@
+#include "Random.h"
+#include <random>
+
+namespace tapioca {
+
+std::uint64_t Random::makeSeed() {
+    std::random_device device;
+    return (static_cast<std::uint64_t>(device()) << 32) | device();
+}
+
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdint>
+
+namespace tapioca {
+
+// xoshiro256** seeded through splitmix64. Unlike the standard library
+// engines and distributions it produces the same numbers with every
+// compiler, so a seed reproduces a game exactly on any platform.
+class Random {
+public:
+    explicit Random(std::uint64_t seed) {
+        for (auto& word : state) {
+            seed += 0x9e3779b97f4a7c15;
+            auto z = seed;
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+            word = z ^ (z >> 31);
+        }
+    }
+
+    std::uint64_t next() {
+        const auto result = rotl(state[1] * 5, 7) * 9;
+        const auto t = state[1] << 17;
+        state[2] ^= state[0];
+        state[3] ^= state[1];
+        state[1] ^= state[2];
+        state[0] ^= state[3];
+        state[2] ^= t;
+        state[3] = rotl(state[3], 45);
+        return result;
+    }
+
+    // Uniform integer in [0, n) by Lemire's multiply-and-reject method.
+    std::uint32_t below(std::uint32_t n) {
+        auto m = static_cast<std::uint64_t>(next() >> 32) * n;
+        if (static_cast<std::uint32_t>(m) < n) {
+            const std::uint32_t threshold = (0u - n) % n;
+            while (static_cast<std::uint32_t>(m) < threshold) {
+                m = static_cast<std::uint64_t>(next() >> 32) * n;
+            }
+        }
+        return static_cast<std::uint32_t>(m >> 32);
+    }
+
+    std::uint64_t hash() const {
+        return state[0] ^ rotl(state[1], 16) ^ rotl(state[2], 32) ^ rotl(state[3], 48);
+    }
+
+    // A fresh seed from std::random_device for games that need not be reproduced.
+    static std::uint64_t makeSeed();
+
+private:
+    std::uint64_t state[4];
+
+    static std::uint64_t rotl(std::uint64_t x, int k) {
+        return (x << k) | (x >> (64 - k));
+    }
+};
+
+}
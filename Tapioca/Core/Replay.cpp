@@ -0,0 +1,252 @@
+#include "Replay.h"
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include "SettledGrid.h"
+
+namespace tapioca {
+
+namespace {
+
+// File layout, all integers little-endian:
+//   "TPRP", version, falling mode, numBlocksX (u16), width, height,
+//   floorHeight, gravity and egg speed (f64), swept collision (u8), block
+//   spawn interval (u32), seed (u64), score (i32), tick count (u64), run
+//   count (u32), then per run the input bits (u8) and the run length as a
+//   LEB128 varint.
+const char magic[4] = { 'T', 'P', 'R', 'P' };
+// Version 2 files have no egg speed and swept collision and load with the
+// defaults.
+const std::uint8_t version = 3;
+
+class Writer {
+public:
+    explicit Writer(std::vector<std::uint8_t>& out) : out(out) {}
+
+    void u8(std::uint8_t value) {
+        out.push_back(value);
+    }
+
+    void uint(std::uint64_t value, int size) {
+        for (int i = 0; i < size; ++i) {
+            out.push_back(static_cast<std::uint8_t>(value >> (8 * i)));
+        }
+    }
+
+    void f64(double value) {
+        std::uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        uint(bits, 8);
+    }
+
+    void varint(std::uint64_t value) {
+        while (value >= 0x80) {
+            out.push_back(static_cast<std::uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        out.push_back(static_cast<std::uint8_t>(value));
+    }
+
+private:
+    std::vector<std::uint8_t>& out;
+};
+
+class Reader {
+public:
+    explicit Reader(const std::vector<std::uint8_t>& in) : in(in) {}
+
+    void bytes(void* data, std::size_t size) {
+        need(size);
+        std::memcpy(data, in.data() + pos, size);
+        pos += size;
+    }
+
+    std::uint8_t u8() {
+        need(1);
+        return in[pos++];
+    }
+
+    std::uint64_t uint(int size) {
+        need(size);
+        std::uint64_t value = 0;
+        for (int i = 0; i < size; ++i) {
+            value |= static_cast<std::uint64_t>(in[pos++]) << (8 * i);
+        }
+        return value;
+    }
+
+    double f64() {
+        const auto bits = uint(8);
+        double value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    std::uint64_t varint() {
+        std::uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            const auto byte = u8();
+            value |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+            if (!(byte & 0x80)) {
+                return value;
+            }
+        }
+        throw std::runtime_error("replay: malformed run length");
+    }
+
+    bool atEnd() const {
+        return pos == in.size();
+    }
+
+private:
+    const std::vector<std::uint8_t>& in;
+    std::size_t pos = 0;
+
+    void need(std::size_t size) const {
+        if (in.size() - pos < size) {
+            throw std::runtime_error("replay: unexpected end of data");
+        }
+    }
+};
+
+// Enough for about an hour of play, so that recording a game does not
+// allocate while it is being played.
+constexpr std::size_t reservedRuns = 1 << 14;
+
+// Far beyond any real board, but small enough that SettledGrid's rows and
+// the spawner's columns stay cheap to build.
+constexpr double maxBoardSize = 1 << 16;
+
+bool isValid(const Board& board) {
+    const auto inRange = [](double value) { return std::isfinite(value) && value > 0.0 && value <= maxBoardSize; };
+    return board.numBlocksX >= 1 && board.numBlocksX <= SettledGrid::maxColumns &&
+        inRange(board.width) && inRange(board.height) && inRange(board.floorHeight) &&
+        std::isfinite(board.eggSpeed) && board.eggSpeed > 0.0 && std::isfinite(board.gravity);
+}
+
+}
+
+Replay::Replay(const World& world) :
+    board(world.getBoard()),
+    mode(world.getBlocks().getMode()),
+    blockSpawnInterval(world.getBlockSpawnInterval()),
+    seed(world.getSeed()) {
+    runs.reserve(reservedRuns);
+}
+
+void Replay::record(const Input& input) {
+    const auto bits = input.toBits();
+    if (!runs.empty() && runs.back().first == bits &&
+        runs.back().second < std::numeric_limits<std::uint32_t>::max()) {
+        ++runs.back().second;
+    } else {
+        runs.emplace_back(bits, 1);
+    }
+    ++numTicks;
+}
+
+World Replay::makeWorld() const {
+    World world(board, mode, seed);
+    world.setBlockSpawnInterval(blockSpawnInterval);
+    return world;
+}
+
+std::vector<std::uint8_t> Replay::serialize() const {
+    std::vector<std::uint8_t> data;
+    Writer writer(data);
+    for (const char c : magic) {
+        writer.u8(static_cast<std::uint8_t>(c));
+    }
+    writer.u8(version);
+    writer.u8(static_cast<std::uint8_t>(mode));
+    writer.uint(static_cast<std::uint64_t>(board.numBlocksX), 2);
+    writer.f64(board.width);
+    writer.f64(board.height);
+    writer.f64(board.floorHeight);
+    writer.f64(board.gravity);
+    writer.f64(board.eggSpeed);
+    writer.u8(board.sweptCollision);
+    writer.uint(static_cast<std::uint32_t>(blockSpawnInterval), 4);
+    writer.uint(seed, 8);
+    writer.uint(static_cast<std::uint32_t>(score), 4);
+    writer.uint(numTicks, 8);
+    writer.uint(runs.size(), 4);
+    for (const auto& run : runs) {
+        writer.u8(run.first);
+        writer.varint(run.second);
+    }
+    return data;
+}
+
+Replay Replay::deserialize(const std::vector<std::uint8_t>& data) {
+    Reader reader(data);
+    char header[sizeof(magic)];
+    reader.bytes(header, sizeof(header));
+    if (std::memcmp(header, magic, sizeof(magic)) != 0) {
+        throw std::runtime_error("replay: not a replay file");
+    }
+    const auto fileVersion = reader.u8();
+    if (fileVersion != 2 && fileVersion != version) {
+        throw std::runtime_error("replay: unsupported version");
+    }
+
+    Replay replay;
+    const auto mode = reader.u8();
+    if (mode > static_cast<std::uint8_t>(FallingMode::Analytic)) {
+        throw std::runtime_error("replay: unknown falling mode");
+    }
+    replay.mode = static_cast<FallingMode>(mode);
+    replay.board.numBlocksX = static_cast<int>(reader.uint(2));
+    replay.board.width = reader.f64();
+    replay.board.height = reader.f64();
+    replay.board.floorHeight = reader.f64();
+    replay.board.gravity = reader.f64();
+    if (fileVersion >= 3) {
+        replay.board.eggSpeed = reader.f64();
+        replay.board.sweptCollision = reader.u8() != 0;
+    }
+    if (!isValid(replay.board)) {
+        throw std::runtime_error("replay: malformed board");
+    }
+    replay.blockSpawnInterval = static_cast<int>(static_cast<std::uint32_t>(reader.uint(4)));
+    replay.seed = reader.uint(8);
+    replay.score = static_cast<int>(static_cast<std::uint32_t>(reader.uint(4)));
+    const auto numTicks = reader.uint(8);
+    const auto numRuns = reader.uint(4);
+    for (std::uint64_t i = 0; i < numRuns; ++i) {
+        const auto bits = reader.u8();
+        const auto length = reader.varint();
+        if (bits > 0xf || length == 0 || length > std::numeric_limits<std::uint32_t>::max()) {
+            throw std::runtime_error("replay: malformed input run");
+        }
+        replay.runs.emplace_back(bits, static_cast<std::uint32_t>(length));
+        replay.numTicks += length;
+    }
+    if (replay.numTicks != numTicks || !reader.atEnd()) {
+        throw std::runtime_error("replay: tick count mismatch");
+    }
+    return replay;
+}
+
+void Replay::save(const std::string& path) const {
+    const auto data = serialize();
+    std::ofstream file(path, std::ios::binary);
+    file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+    if (!file) {
+        throw std::runtime_error("replay: cannot write " + path);
+    }
+}
+
+Replay Replay::load(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        throw std::runtime_error("replay: cannot open " + path);
+    }
+    const std::vector<std::uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    return deserialize(data);
+}
+
+}
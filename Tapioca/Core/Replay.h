@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+#include "Board.h"
+#include "Input.h"
+#include "World.h"
+
+namespace tapioca {
+
+// Everything needed to play a game again tick for tick: the settings and
+// seed of its World and the buttons held in every tick. Inputs are kept as
+// runs of identical ticks, since buttons are held for many ticks at a time.
+class Replay {
+public:
+    Replay() = default;
+
+    // Starts recording a game that begins in the given state.
+    explicit Replay(const World& world);
+
+    // Appends the input of the next tick.
+    void record(const Input& input);
+
+    // Stores the final score so that playback can detect a desync.
+    void finish(const World& world) {
+        score = world.getScore();
+    }
+
+    // A World in the state the recorded game started in.
+    World makeWorld() const;
+
+    std::uint64_t getNumTicks() const {
+        return numTicks;
+    }
+
+    std::uint64_t getSeed() const {
+        return seed;
+    }
+
+    int getScore() const {
+        return score;
+    }
+
+    std::vector<std::uint8_t> serialize() const;
+
+    // Throws std::runtime_error if data is not a valid replay.
+    static Replay deserialize(const std::vector<std::uint8_t>& data);
+
+    // Throw std::runtime_error on I/O errors.
+    void save(const std::string& path) const;
+    static Replay load(const std::string& path);
+
+    // Hands out the recorded inputs one tick at a time.
+    class Cursor {
+    public:
+        explicit Cursor(const Replay& replay) : replay(&replay) {}
+
+        bool atEnd() const {
+            return run >= replay->runs.size();
+        }
+
+        Input next() {
+            const auto& current = replay->runs[run];
+            if (++offset >= current.second) {
+                ++run;
+                offset = 0;
+            }
+            return Input::fromBits(current.first);
+        }
+
+    private:
+        const Replay* replay;
+        std::size_t run = 0;
+        std::uint32_t offset = 0;
+    };
+
+private:
+    // (input bits, number of ticks)
+    using Run = std::pair<std::uint8_t, std::uint32_t>;
+
+    Board board;
+    FallingMode mode = FallingMode::Stepped;
+    int blockSpawnInterval = World::defaultBlockSpawnInterval;
+    std::uint64_t seed = 0;
+    int score = 0;
+    std::uint64_t numTicks = 0;
+    std::vector<Run> runs;
+};
+
+}
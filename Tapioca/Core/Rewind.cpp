@@ -0,0 +1,203 @@
+#include "Rewind.h"
+#include <algorithm>
+#include <cstring>
+
+namespace tapioca {
+
+const int RewindBuffer::keyInterval = 30;
+
+namespace {
+
+void putVarint(std::vector<std::uint8_t>& out, std::size_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<std::uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<std::uint8_t>(value));
+}
+
+std::size_t getVarint(const std::uint8_t*& in) {
+    std::size_t value = 0;
+    for (int shift = 0;; shift += 7) {
+        const auto byte = *in++;
+        value |= static_cast<std::size_t>(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            return value;
+        }
+    }
+}
+
+// A run of this many equal bytes ends a literal; shorter ones are cheaper
+// to copy than to skip.
+constexpr std::size_t minSkip = 8;
+
+}
+
+RewindBuffer::RewindBuffer(int maxTicks, std::size_t maxBytes) :
+    ring(maxBytes),
+    frames(std::max(maxTicks, 2 * keyInterval)) {}
+
+void RewindBuffer::clear() {
+    first = 0;
+    count = 0;
+    sinceKey = 0;
+}
+
+void RewindBuffer::record(const World& world) {
+    world.save(current);
+    // A delta is never more than about twice the state it encodes.
+    keyframe.reserve(current.capacity());
+    encoded.reserve(2 * current.capacity() + 16);
+    if (current.size() > ring.size()) {
+        // Cannot be kept; starting over at least leaves no stale history.
+        clear();
+        return;
+    }
+    if (count == static_cast<int>(frames.size())) {
+        dropOldestGroup();
+    }
+
+    for (;;) {
+        const bool key = count == 0 || sinceKey + 1 >= keyInterval;
+        const std::uint8_t* data = current.data();
+        std::size_t size = current.size();
+        if (!key) {
+            encodeDelta(keyframe, current);
+            data = encoded.data();
+            size = encoded.size();
+        }
+
+        std::size_t offset = 0;
+        if (count > 0) {
+            const auto& newest = frames[slot(count - 1)];
+            offset = newest.offset + newest.size;
+            if (offset + size > ring.size()) {
+                offset = 0;
+            }
+        }
+        while (count > 0 && overlapsLive(offset, size)) {
+            dropOldestGroup();
+        }
+        if (!key && count == 0) {
+            // The keyframe this delta refers to was dropped to make room.
+            continue;
+        }
+
+        std::memcpy(ring.data() + offset, data, size);
+        frames[slot(count)] = { world.getTick(), offset, size, key };
+        ++count;
+        if (key) {
+            keyframe.assign(current.data(), current.size());
+            sinceKey = 0;
+        } else {
+            ++sinceKey;
+        }
+        return;
+    }
+}
+
+void RewindBuffer::restore(int index, World& world) {
+    int key = index;
+    while (!frames[slot(key)].key) {
+        --key;
+    }
+    const auto& keyFrame = frames[slot(key)];
+    const auto* keyData = ring.data() + keyFrame.offset;
+    if (key == index) {
+        decoded.assign(keyData, keyFrame.size);
+    } else {
+        const auto& frame = frames[slot(index)];
+        decodeDelta(keyData, keyFrame.size, ring.data() + frame.offset);
+        decoded.assign(scratch.data(), scratch.size());
+    }
+    world.restore(decoded);
+}
+
+std::size_t RewindBuffer::getUsedBytes() const {
+    std::size_t used = 0;
+    for (int i = 0; i < count; ++i) {
+        used += frames[slot(i)].size;
+    }
+    return used;
+}
+
+// Whether [offset, offset + size) meets the ring span from the oldest frame
+// to the end of the newest, which may wrap around.
+bool RewindBuffer::overlapsLive(std::size_t offset, std::size_t size) const {
+    const std::size_t start = frames[slot(0)].offset;
+    const auto& newest = frames[slot(count - 1)];
+    const std::size_t end = newest.offset + newest.size;
+    const auto overlaps = [&](std::size_t a, std::size_t b) { return offset < b && a < offset + size; };
+    if (start < end) {
+        return overlaps(start, end);
+    }
+    return overlaps(start, ring.size()) || overlaps(0, end);
+}
+
+// Drops the oldest keyframe together with the deltas that depend on it.
+void RewindBuffer::dropOldestGroup() {
+    do {
+        first = slot(1);
+        --count;
+    } while (count > 0 && !frames[first].key);
+}
+
+// Encodes state as its size followed by (skip, literal length, literal
+// bytes) triples against base; bytes past the end of base are always literal.
+void RewindBuffer::encodeDelta(const Snapshot& base, const Snapshot& state) {
+    const auto* from = base.data();
+    const auto* to = state.data();
+    const std::size_t baseSize = base.size();
+    const std::size_t size = state.size();
+    const auto same = [&](std::size_t i) { return i < baseSize && from[i] == to[i]; };
+
+    encoded.clear();
+    putVarint(encoded, size);
+    const std::size_t common = std::min(size, baseSize);
+    std::size_t i = 0;
+    while (i < size) {
+        std::size_t literal = i;
+        // Most of a state is unchanged, so skip it a word at a time.
+        while (literal + 8 <= common && std::memcmp(from + literal, to + literal, 8) == 0) {
+            literal += 8;
+        }
+        while (literal < size && same(literal)) {
+            ++literal;
+        }
+        std::size_t end = literal;
+        while (end < size) {
+            if (!same(end)) {
+                ++end;
+                continue;
+            }
+            std::size_t run = end;
+            while (run < size && run - end < minSkip && same(run)) {
+                ++run;
+            }
+            if (run - end >= minSkip || run == size) {
+                break;
+            }
+            end = run;
+        }
+        putVarint(encoded, literal - i);
+        putVarint(encoded, end - literal);
+        encoded.insert(encoded.end(), to + literal, to + end);
+        i = end;
+    }
+}
+
+void RewindBuffer::decodeDelta(const std::uint8_t* base, std::size_t baseSize, const std::uint8_t* delta) {
+    const std::size_t size = getVarint(delta);
+    scratch.resize(size);
+    std::memcpy(scratch.data(), base, std::min(size, baseSize));
+    std::size_t i = 0;
+    while (i < size) {
+        i += getVarint(delta);
+        const std::size_t literal = getVarint(delta);
+        std::memcpy(scratch.data() + i, delta, literal);
+        delta += literal;
+        i += literal;
+    }
+}
+
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "Snapshot.h"
+#include "World.h"
+
+namespace tapioca {
+
+// Keeps the states of the last ticks of a game for scrubbing through them.
+// Every keyInterval-th state is stored whole and the others as the bytes
+// that differ from the keyframe before them, all in one preallocated byte
+// ring. The oldest states are dropped, a keyframe group at a time, when the
+// ring or the tick limit is full. The scratch buffers are sized for the
+// largest state the world has room for, so recording allocates nothing
+// after the first record of a world.
+class RewindBuffer {
+public:
+    static const int keyInterval;
+
+    RewindBuffer(int maxTicks, std::size_t maxBytes);
+
+    void clear();
+
+    // Stores the state of world, which should be one tick after the last
+    // recorded one.
+    void record(const World& world);
+
+    // Number of states held; 0 is the oldest.
+    int size() const {
+        return count;
+    }
+
+    std::uint64_t getTick(int index) const {
+        return frames[slot(index)].tick;
+    }
+
+    // Puts world into the state recorded at index. world must have the same
+    // board and falling mode as the recorded one.
+    void restore(int index, World& world);
+
+    // Bytes of the ring in use.
+    std::size_t getUsedBytes() const;
+
+private:
+    struct Frame {
+        std::uint64_t tick;
+        std::size_t offset;
+        std::size_t size;
+        bool key;
+    };
+
+    std::vector<std::uint8_t> ring;
+    std::vector<Frame> frames;
+    int first = 0;
+    int count = 0;
+    int sinceKey = 0;
+    Snapshot current;
+    Snapshot keyframe;
+    Snapshot decoded;
+    std::vector<std::uint8_t> encoded;
+    std::vector<std::uint8_t> scratch;
+
+    int slot(int index) const {
+        return (first + index) % static_cast<int>(frames.size());
+    }
+
+    bool overlapsLive(std::size_t offset, std::size_t size) const;
+    void dropOldestGroup();
+    void encodeDelta(const Snapshot& base, const Snapshot& state);
+    void decodeDelta(const std::uint8_t* base, std::size_t baseSize, const std::uint8_t* delta);
+};
+
+}
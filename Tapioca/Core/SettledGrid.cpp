@@ -0,0 +1,40 @@
+#include "SettledGrid.h"
+#include <cmath>
+#include <stdexcept>
+#include "Block.h"
+
+namespace tapioca {
+
+void SettledGrid::reset(const Board& board) {
+    if (board.numBlocksX > maxColumns) {
+        throw std::invalid_argument("SettledGrid supports at most 64 columns");
+    }
+    rowYs.clear();
+    double y = Block::getRestingY(-Block::size, board.floorY());
+    rowYs.push_back(y);
+    while (y > 0.0) {
+        y = Block::getRestingY(-Block::size, y);
+        rowYs.push_back(y);
+    }
+    rowPitch = rowYs.size() > 1 ? rowYs[0] - rowYs[1] : Block::size;
+    rows.assign(rowYs.size(), 0);
+}
+
+int SettledGrid::getRowAt(double y) const {
+    const auto row = static_cast<long long>(std::lround((rowYs.front() - y) / rowPitch));
+    if (row < 0 || row >= getNumRows() || rowYs[row] != y) {
+        return -1;
+    }
+    return static_cast<int>(row);
+}
+
+// FNV-1a over the row masks.
+std::uint64_t SettledGrid::hash() const {
+    std::uint64_t h = 14695981039346656037ull;
+    for (const auto row : rows) {
+        h = (h ^ row) * 1099511628211ull;
+    }
+    return h;
+}
+
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+#include "Board.h"
+#include "Snapshot.h"
+
+namespace tapioca {
+
+// Settled blocks rest either on the floor or on another settled block, and
+// every block falls from the same spawn height at the same speed, so they
+// can only ever occupy a fixed set of rows. Each row is stored as a bitmask
+// of occupied columns. Blocks that are falling are not part of the grid.
+class SettledGrid {
+public:
+    using Row = std::uint64_t;
+    static constexpr int maxColumns = 64;
+
+    void reset(const Board& board);
+
+    // Empties every row.
+    void clear() {
+        std::fill(rows.begin(), rows.end(), 0);
+    }
+
+    // Returns the row a block settled at y occupies, or -1 if y is not on a row.
+    int getRowAt(double y) const;
+
+    double getRowY(int row) const {
+        return rowYs[row];
+    }
+
+    int getNumRows() const {
+        return static_cast<int>(rows.size());
+    }
+
+    void set(int column, int row) {
+        rows[row] |= Row(1) << column;
+    }
+
+    void clear(int column, int row) {
+        rows[row] &= ~(Row(1) << column);
+    }
+
+    bool isSet(int column, int row) const {
+        return (rows[row] >> column) & 1;
+    }
+
+    // A block settled in a row at or above the top of the board ends the game.
+    bool isToppedOut() const {
+        return rows.back() != 0;
+    }
+
+    // Number of settled blocks stacked in the column. Settled blocks always
+    // form a gapless stack from the floor up.
+    int getColumnHeight(int column) const {
+        int height = 0;
+        while (height < getNumRows() && isSet(column, height)) {
+            ++height;
+        }
+        return height;
+    }
+
+    std::uint64_t hash() const;
+
+    // The row positions are derived from the board and not saved.
+    void save(Snapshot& snapshot) const {
+        snapshot.writeArray(rows);
+    }
+
+    void restore(Snapshot::Reader& reader) {
+        reader.readArray(rows);
+    }
+
+    const std::vector<Row>& getRows() const {
+        return rows;
+    }
+
+private:
+    // rows.front() is the row on the floor, rows.back() the first row whose
+    // top is at or above the top of the board.
+    std::vector<Row> rows;
+    std::vector<double> rowYs;
+    double rowPitch = 0.0;
+};
+
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include "Snapshot.h"
+
+namespace tapioca {
+
+// Removes element index from every array by moving the last element into
+// its place.
+template <class... Arrays>
+void swapRemove(int index, Arrays&... arrays) {
+    ((arrays[index] = arrays.back(), arrays.pop_back()), ...);
+}
+
+// Stable handles to the elements of dense arrays that swapRemove compacts.
+// A handle is a serial number above a slot. The slot holds the element's
+// current index and is reused once the element is removed; the serial,
+// which the owner never hands out twice, tells an old handle from the one
+// of the element now in its slot. Handles therefore order elements by
+// serial. add(), remove(), move() and find() are O(1); clear() and
+// restore(), which rebuilds every slot, are O(n).
+class SlotTable {
+public:
+    using Handle = std::uint64_t;
+    // Never handed out, so find() returns -1 for it.
+    static constexpr Handle none = std::numeric_limits<Handle>::max();
+
+    void clear() {
+        slots.clear();
+        freeSlots.clear();
+    }
+
+    void reserve(std::size_t size) {
+        slots.reserve(size);
+        freeSlots.reserve(size);
+    }
+
+    // Returns the handle of a new element at index.
+    Handle add(int index, std::uint32_t serial) {
+        std::uint32_t slot;
+        if (freeSlots.empty()) {
+            slot = static_cast<std::uint32_t>(slots.size());
+            slots.push_back({ index, serial });
+        } else {
+            slot = freeSlots.back();
+            freeSlots.pop_back();
+            slots[slot] = { index, serial };
+        }
+        return static_cast<Handle>(serial) << 32 | slot;
+    }
+
+    // Frees the slot of a removed element.
+    void remove(Handle handle) {
+        const auto slot = static_cast<std::uint32_t>(handle);
+        slots[slot].index = -1;
+        freeSlots.push_back(slot);
+    }
+
+    // Records that the element has moved to index.
+    void move(Handle handle, int index) {
+        slots[static_cast<std::uint32_t>(handle)].index = index;
+    }
+
+    // Returns the index of the element, or -1 once it has been removed.
+    int find(Handle handle) const {
+        const auto slot = static_cast<std::uint32_t>(handle);
+        if (handle == none || slot >= slots.size() || slots[slot].index < 0 || slots[slot].serial != handle >> 32) {
+            return -1;
+        }
+        return slots[slot].index;
+    }
+
+    // Only the free slots are saved; restore() recovers the rest from the
+    // handles of the elements, indexed like them.
+    void save(Snapshot& snapshot) const {
+        snapshot.writeArray(freeSlots);
+    }
+
+    void restore(Snapshot::Reader& reader, const std::vector<Handle>& handles) {
+        reader.readArray(freeSlots);
+        std::size_t size = 0;
+        for (const auto slot : freeSlots) {
+            size = std::max<std::size_t>(size, slot + 1);
+        }
+        for (const auto handle : handles) {
+            size = std::max<std::size_t>(size, static_cast<std::uint32_t>(handle) + std::size_t(1));
+        }
+        slots.assign(size, { -1, 0 });
+        for (int i = 0; i < static_cast<int>(handles.size()); ++i) {
+            slots[static_cast<std::uint32_t>(handles[i])] = { i, static_cast<std::uint32_t>(handles[i] >> 32) };
+        }
+    }
+
+private:
+    struct Slot {
+        int index;
+        std::uint32_t serial;
+    };
+
+    std::vector<Slot> slots;
+    // Slots of removed elements, reused last in, first out.
+    std::vector<std::uint32_t> freeSlots;
+};
+
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+namespace tapioca {
+
+// Flat byte buffer holding a copy of a game's state as plain values and
+// arrays. Saving again into the same snapshot reuses its buffer, so once it
+// has grown to the size of the state neither saving nor restoring allocates.
+// Snapshots are only meant to be restored by the build that saved them.
+class Snapshot {
+public:
+    void clear() {
+        used = 0;
+        slack = 0;
+    }
+
+    std::size_t size() const {
+        return used;
+    }
+
+    const std::uint8_t* data() const {
+        return buffer.data();
+    }
+
+    // Bytes that fit without growing the buffer.
+    std::size_t capacity() const {
+        return buffer.size();
+    }
+
+    void reserve(std::size_t size) {
+        if (buffer.size() < size) {
+            buffer.resize(size);
+        }
+    }
+
+    // Replaces the contents with size bytes taken from another snapshot.
+    void assign(const std::uint8_t* bytes, std::size_t size) {
+        clear();
+        writeBytes(bytes, size);
+    }
+
+    template <class T>
+    void write(const T& value) {
+        static_assert(std::is_trivially_copyable<T>::value, "snapshots hold plain values only");
+        writeBytes(&value, sizeof(T));
+    }
+
+    // Keeps room for the array's whole capacity, so that saving arrays that
+    // have not outgrown their capacity again does not grow the buffer.
+    template <class T>
+    void writeArray(const std::vector<T>& values) {
+        static_assert(std::is_trivially_copyable<T>::value, "snapshots hold plain values only");
+        slack += (values.capacity() - values.size()) * sizeof(T);
+        write(values.size());
+        writeBytes(values.data(), values.size() * sizeof(T));
+    }
+
+    // Reads the values back in the order they were written.
+    class Reader {
+    public:
+        explicit Reader(const Snapshot& snapshot) : snapshot(snapshot) {}
+
+        template <class T>
+        void read(T& value) {
+            static_assert(std::is_trivially_copyable<T>::value, "snapshots hold plain values only");
+            readBytes(&value, sizeof(T));
+        }
+
+        // Allocates only if values has less capacity than the array.
+        template <class T>
+        void readArray(std::vector<T>& values) {
+            static_assert(std::is_trivially_copyable<T>::value, "snapshots hold plain values only");
+            std::size_t count;
+            read(count);
+            values.resize(count);
+            readBytes(values.data(), count * sizeof(T));
+        }
+
+    private:
+        const Snapshot& snapshot;
+        std::size_t pos = 0;
+
+        void readBytes(void* data, std::size_t size) {
+            if (snapshot.used - pos < size) {
+                throw std::out_of_range("snapshot: read past the end");
+            }
+            if (size > 0) {
+                std::memcpy(data, snapshot.buffer.data() + pos, size);
+            }
+            pos += size;
+        }
+    };
+
+private:
+    std::vector<std::uint8_t> buffer;
+    std::size_t used = 0;
+    // Unused capacity of the arrays written since clear().
+    std::size_t slack = 0;
+
+    void writeBytes(const void* data, std::size_t size) {
+        if (buffer.size() < used + size + slack) {
+            buffer.resize(std::max(used + size + slack, buffer.size() * 2));
+        }
+        if (size > 0) {
+            std::memcpy(buffer.data() + used, data, size);
+        }
+        used += size;
+    }
+};
+
+}
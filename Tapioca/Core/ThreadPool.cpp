@@ -0,0 +1,104 @@
+#include "ThreadPool.h"
+#include <algorithm>
+
+namespace tapioca {
+
+namespace {
+
+// The pool and queue the calling thread works for, if it is a worker.
+thread_local const ThreadPool* currentPool = nullptr;
+thread_local unsigned currentQueue = 0;
+
+}
+
+ThreadPool::ThreadPool(unsigned numThreads) {
+    if (numThreads == 0) {
+        numThreads = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+    for (unsigned i = 0; i < numThreads; ++i) {
+        queues.push_back(std::make_unique<Queue>());
+    }
+    for (unsigned i = 0; i < numThreads; ++i) {
+        workers.emplace_back([this, i] { run(i); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+    unsigned index;
+    {
+        // Counted before it is pushed so that a worker taking it right away
+        // never sees the count go below zero.
+        std::lock_guard<std::mutex> lock(mutex);
+        index = currentPool == this ? currentQueue : nextQueue++ % size();
+        ++pending;
+        ++queued;
+    }
+    {
+        std::lock_guard<std::mutex> lock(queues[index]->mutex);
+        queues[index]->tasks.push_back(std::move(task));
+    }
+    wake.notify_one();
+}
+
+void ThreadPool::wait() {
+    std::unique_lock<std::mutex> lock(mutex);
+    idle.wait(lock, [this] { return pending == 0; });
+}
+
+void ThreadPool::run(unsigned index) {
+    currentPool = this;
+    currentQueue = index;
+    for (;;) {
+        std::function<void()> task;
+        if (pop(index, task)) {
+            task();
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--pending == 0) {
+                idle.notify_all();
+            }
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(mutex);
+        wake.wait(lock, [this] { return stopping || queued > 0; });
+        if (stopping && queued == 0) {
+            return;
+        }
+    }
+}
+
+// Takes the newest task of the worker's own queue, or else the oldest task
+// of another worker's.
+bool ThreadPool::pop(unsigned index, std::function<void()>& task) {
+    for (unsigned i = 0; i < size(); ++i) {
+        auto& queue = *queues[(index + i) % size()];
+        std::unique_lock<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty()) {
+            continue;
+        }
+        if (i == 0) {
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+        } else {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+        }
+        lock.unlock();
+        std::lock_guard<std::mutex> countLock(mutex);
+        --queued;
+        return true;
+    }
+    return false;
+}
+
+}
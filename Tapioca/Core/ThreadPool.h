@@ -0,0 +1,56 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace tapioca {
+
+// Work-stealing thread pool. Every worker has its own task queue: tasks
+// submitted from a worker go to the back of its queue and are taken from
+// the back again, while idle workers steal from the front of the others.
+// Tasks must not throw.
+class ThreadPool {
+public:
+    // 0 picks one worker per hardware thread.
+    explicit ThreadPool(unsigned numThreads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    void submit(std::function<void()> task);
+
+    // Blocks until every submitted task has finished. Must not be called from a task.
+    void wait();
+
+    unsigned size() const {
+        return static_cast<unsigned>(queues.size());
+    }
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable idle;
+    // Guarded by mutex.
+    std::size_t queued = 0;
+    std::size_t pending = 0;
+    unsigned nextQueue = 0;
+    bool stopping = false;
+
+    void run(unsigned index);
+    bool pop(unsigned index, std::function<void()>& task);
+};
+
+}
@@ -0,0 +1,92 @@
+#include "VectorEnv.h"
+#include <algorithm>
+
+namespace tapioca {
+
+VectorEnv::VectorEnv(int numEnvs, std::uint64_t seed, const Board& board, FallingMode mode, unsigned numThreads) :
+    board(board),
+    mode(mode),
+    seed(seed),
+    worlds(numEnvs, World(board, mode, seed)),
+    episodes(numEnvs, 0),
+    encoder(board) {
+    batch.playerX.resize(numEnvs);
+    batch.playerY.resize(numEnvs);
+    batch.playerVy.resize(numEnvs);
+    batch.eggState.resize(numEnvs);
+    batch.eggX.resize(numEnvs);
+    batch.eggY.resize(numEnvs);
+    batch.numBlocks.resize(numEnvs);
+    batch.reward.resize(numEnvs);
+    batch.done.resize(numEnvs);
+    batch.observations.resize(static_cast<std::size_t>(numEnvs) * encoder.size());
+    if (numThreads > 1) {
+        pool = std::make_unique<ThreadPool>(numThreads);
+    }
+    reset();
+}
+
+void VectorEnv::reset() {
+    std::fill(episodes.begin(), episodes.end(), 0);
+    for (int i = 0; i < size(); ++i) {
+        startEpisode(i);
+        batch.reward[i] = 0.0f;
+        batch.done[i] = false;
+    }
+}
+
+void VectorEnv::step(const std::uint8_t* actions) {
+    if (!pool) {
+        stepRange(0, size(), actions);
+        return;
+    }
+    // A few slices per thread even out games of different cost.
+    const int numSlices = static_cast<int>(pool->size()) * 4;
+    const int sliceSize = std::max(1, (size() + numSlices - 1) / numSlices);
+    for (int begin = 0; begin < size(); begin += sliceSize) {
+        const int end = std::min(size(), begin + sliceSize);
+        pool->submit([this, begin, end, actions] { stepRange(begin, end, actions); });
+    }
+    pool->wait();
+}
+
+void VectorEnv::stepRange(int begin, int end, const std::uint8_t* actions) {
+    for (int i = begin; i < end; ++i) {
+        auto& world = worlds[i];
+        const int score = world.getScore();
+        world.step(Input::fromBits(actions[i]));
+        batch.reward[i] = static_cast<float>(world.getScore() - score);
+        batch.done[i] = world.isGameOver();
+        if (world.isGameOver()) {
+            ++episodes[i];
+            startEpisode(i);
+        } else {
+            observe(i);
+        }
+    }
+}
+
+void VectorEnv::startEpisode(int i) {
+    worlds[i].reset(seed + i + episodes[i] * worlds.size());
+    observe(i);
+}
+
+void VectorEnv::observe(int i) {
+    const auto& player = worlds[i].getPlayer();
+    batch.playerX[i] = player.getRect().x;
+    batch.playerY[i] = player.getRect().y;
+    batch.playerVy[i] = player.getVelocityY();
+    if (const auto& egg = player.getEgg()) {
+        batch.eggState[i] = egg->isExploding() ? EnvBatch::Exploding : EnvBatch::Flying;
+        batch.eggX[i] = egg->getRect().x;
+        batch.eggY[i] = egg->getRect().y;
+    } else {
+        batch.eggState[i] = EnvBatch::NoEgg;
+        batch.eggX[i] = 0.0;
+        batch.eggY[i] = 0.0;
+    }
+    batch.numBlocks[i] = worlds[i].getBlocks().size();
+    encoder.encode(worlds[i], &batch.observations[static_cast<std::size_t>(i) * encoder.size()]);
+}
+
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "Board.h"
+#include "Observation.h"
+#include "ThreadPool.h"
+#include "World.h"
+
+namespace tapioca {
+
+// Per-environment results of the last VectorEnv step, one array per field
+// with one entry per environment.
+struct EnvBatch {
+    enum EggState : std::uint8_t {
+        NoEgg,
+        Flying,
+        Exploding
+    };
+
+    std::vector<double> playerX;
+    std::vector<double> playerY;
+    std::vector<double> playerVy;
+    std::vector<std::uint8_t> eggState;
+    // Top left of the egg; 0 when there is none.
+    std::vector<double> eggX;
+    std::vector<double> eggY;
+    std::vector<int> numBlocks;
+    // Score gained in the step.
+    std::vector<float> reward;
+    // Whether the step ended the game. The environment has then already been
+    // reset and the other fields describe the first state of the next game.
+    std::vector<std::uint8_t> done;
+    // ObservationEncoder output of every environment, back to back.
+    std::vector<float> observations;
+};
+
+// Steps a batch of independent games in lockstep for training agents.
+// Environment i plays its games with seeds seed + i, seed + i + size(),
+// seed + i + 2 * size() and so on, so a run is reproducible whatever the
+// number of threads.
+class VectorEnv {
+public:
+    // numThreads > 1 steps contiguous slices of the batch on a ThreadPool.
+    VectorEnv(int numEnvs, std::uint64_t seed, const Board& board = Board(),
+        FallingMode mode = FallingMode::Analytic, unsigned numThreads = 1);
+
+    // Starts every environment's first game over.
+    void reset();
+
+    // Advances every environment by one tick. actions[i] holds the
+    // Input::toBits() of environment i.
+    void step(const std::uint8_t* actions);
+
+    int size() const {
+        return static_cast<int>(worlds.size());
+    }
+
+    const EnvBatch& getBatch() const {
+        return batch;
+    }
+
+    const World& getWorld(int i) const {
+        return worlds[i];
+    }
+
+    const ObservationEncoder& getEncoder() const {
+        return encoder;
+    }
+
+private:
+    Board board;
+    FallingMode mode;
+    std::uint64_t seed;
+    std::vector<World> worlds;
+    std::vector<std::uint64_t> episodes;
+    ObservationEncoder encoder;
+    EnvBatch batch;
+    std::unique_ptr<ThreadPool> pool;
+
+    void stepRange(int begin, int end, const std::uint8_t* actions);
+    void startEpisode(int i);
+    void observe(int i);
+};
+
+}
@@ -0,0 +1,144 @@
+#include "World.h"
+#include <algorithm>
+#include <stdexcept>
+#include "Profiler.h"
+
+namespace tapioca {
+
+const int World::defaultBlockSpawnInterval = secondsToTicks(0.5);
+
+World::World(const Board& board, FallingMode mode, std::uint64_t seed) :
+    board(board),
+    player(board),
+    blocks(board, mode),
+    seed(seed),
+    rng(seed) {}
+
+void World::reset(std::uint64_t seed) {
+    player = Player(board);
+    blocks.clear();
+    this->seed = seed;
+    rng = Random(seed);
+    tick = 0;
+    spawnTicks = 0;
+    score = 0;
+    blocksDestroyed = 0;
+    gameOver = false;
+}
+
+void World::step(const Input& input) {
+    if (gameOver) {
+        return;
+    }
+    TAPIOCA_ZONE("World::step");
+    ++tick;
+
+    if (blockSpawnInterval > 0 && ++spawnTicks >= blockSpawnInterval) {
+        blocks.spawn(static_cast<int>(rng.below(board.numBlocksX)), tick - 1);
+        spawnTicks = 0;
+    }
+    if (!blocks.update(tick)) {
+        gameOver = true;
+        return;
+    }
+
+    const int hit = player.update(input, blocks, board);
+    if (hit >= 0) {
+        score += static_cast<int>(100.0 * blocks.getHitHeight(hit));
+        blocks.remove(hit);
+        ++blocksDestroyed;
+    }
+    if (player.isDead()) {
+        gameOver = true;
+    }
+}
+
+void World::fastForward(std::uint64_t ticks) {
+    while (ticks > 0 && !gameOver) {
+        const auto quiet = std::min(ticks, countQuietTicks());
+        if (quiet > 0) {
+            tick += quiet;
+            if (blockSpawnInterval > 0) {
+                spawnTicks += static_cast<int>(quiet);
+            }
+            player.rest(static_cast<int>(quiet));
+            if (!blocks.update(tick)) {
+                gameOver = true;
+            }
+            ticks -= quiet;
+        } else {
+            step(Input());
+            --ticks;
+        }
+    }
+}
+
+void World::save(Snapshot& snapshot) const {
+    snapshot.clear();
+    snapshot.write(board);
+    snapshot.write(blocks.getMode());
+    snapshot.write(player);
+    snapshot.write(rng);
+    snapshot.write(seed);
+    snapshot.write(tick);
+    snapshot.write(blockSpawnInterval);
+    snapshot.write(spawnTicks);
+    snapshot.write(score);
+    snapshot.write(blocksDestroyed);
+    snapshot.write(gameOver);
+    blocks.save(snapshot);
+}
+
+void World::restore(const Snapshot& snapshot) {
+    Snapshot::Reader reader(snapshot);
+    Board savedBoard;
+    FallingMode savedMode;
+    reader.read(savedBoard);
+    reader.read(savedMode);
+    if (savedBoard != board || savedMode != blocks.getMode()) {
+        throw std::invalid_argument("snapshot of a different board or falling mode");
+    }
+    reader.read(player);
+    reader.read(rng);
+    reader.read(seed);
+    reader.read(tick);
+    reader.read(blockSpawnInterval);
+    reader.read(spawnTicks);
+    reader.read(score);
+    reader.read(blocksDestroyed);
+    reader.read(gameOver);
+    blocks.restore(reader);
+}
+
+std::uint64_t World::getHash() const {
+    using namespace zobrist;
+    return blocks.getHash() ^ player.hash() ^
+        key(WorldTime, static_cast<std::int64_t>(tick), static_cast<std::int64_t>(blockSpawnInterval) << 32 | spawnTicks) ^
+        key(WorldScore, score, static_cast<std::int64_t>(blocksDestroyed) << 1 | gameOver) ^
+        key(WorldRandom, static_cast<std::int64_t>(rng.hash()));
+}
+
+std::uint64_t World::computeHash() const {
+    return getHash() ^ blocks.getHash() ^ blocks.computeHash();
+}
+
+BlockId World::spawnBlock(int column) {
+    return blocks.spawn(column, tick);
+}
+
+// Number of upcoming ticks that would change nothing but the positions of
+// falling blocks, which analytic mode evaluates on demand anyway. The tick
+// something happens in is always stepped normally.
+std::uint64_t World::countQuietTicks() const {
+    if (blocks.getMode() != FallingMode::Analytic || !player.isResting()) {
+        return 0;
+    }
+    auto next = blocks.getNextLandingTick();
+    if (blockSpawnInterval > 0) {
+        next = std::min(next, tick + static_cast<std::uint64_t>(blockSpawnInterval - spawnTicks));
+    }
+    next = std::min(next, blocks.getContactTick(player.getRect()));
+    return next > tick + 1 ? next - tick - 1 : 0;
+}
+
+}
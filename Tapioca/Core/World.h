@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cstdint>
+#include "BlockField.h"
+#include "Board.h"
+#include "Input.h"
+#include "Player.h"
+#include "Random.h"
+#include "Snapshot.h"
+
+namespace tapioca {
+
+// Complete state of one game. step() advances it by a single tick without
+// touching any window, clock or input device, so it can be driven by the
+// Siv3D front-end and by headless runners alike.
+class World {
+public:
+    static const int defaultBlockSpawnInterval;
+
+    // Games with the same seed spawn the same blocks in the same columns.
+    explicit World(const Board& board = Board(), FallingMode mode = FallingMode::Stepped,
+        std::uint64_t seed = Random::makeSeed());
+
+    // Starts a new game with the given seed on the same board, falling
+    // mode and spawn interval, as a new World would, but without
+    // allocating once the World has been reset before.
+    void reset(std::uint64_t seed);
+
+    void step(const Input& input);
+
+    // Advances the given number of ticks with no buttons held. In analytic
+    // mode, stretches in which the player is at rest and no block spawns,
+    // lands or reaches the player are skipped in one go.
+    void fastForward(std::uint64_t ticks);
+
+    // Replaces the contents of snapshot with the complete state of the game.
+    void save(Snapshot& snapshot) const;
+
+    // Returns to the state of a snapshot saved from a World with the same
+    // board and falling mode, in time linear in the state size. Throws
+    // std::invalid_argument for other snapshots.
+    void restore(const Snapshot& snapshot);
+
+    // Drops a new block into the given column, as the spawner does every blockSpawnInterval ticks.
+    BlockId spawnBlock(int column);
+
+    // Ticks between two blocks dropped by the world itself; 0 disables the spawner.
+    void setBlockSpawnInterval(int ticks) {
+        blockSpawnInterval = ticks;
+    }
+
+    int getBlockSpawnInterval() const {
+        return blockSpawnInterval;
+    }
+
+    bool isGameOver() const {
+        return gameOver;
+    }
+
+    int getScore() const {
+        return score;
+    }
+
+    int getBlocksDestroyed() const {
+        return blocksDestroyed;
+    }
+
+    std::uint64_t getSeed() const {
+        return seed;
+    }
+
+    std::uint64_t getTick() const {
+        return tick;
+    }
+
+    const Board& getBoard() const {
+        return board;
+    }
+
+    const Player& getPlayer() const {
+        return player;
+    }
+
+    const BlockField& getBlocks() const {
+        return blocks;
+    }
+
+    // Zobrist hash of the state of the game, in constant time: the blocks'
+    // part is kept up to date by BlockField and the rest is hashed on the
+    // spot. Equal states hash equally whatever the falling mode; the board
+    // and seed are not included.
+    std::uint64_t getHash() const;
+
+    // The same hash computed from every block, for checking getHash().
+    std::uint64_t computeHash() const;
+
+private:
+    Board board;
+    Player player;
+    BlockField blocks;
+    std::uint64_t seed;
+    Random rng;
+    std::uint64_t tick = 0;
+    int blockSpawnInterval = defaultBlockSpawnInterval;
+    int spawnTicks = 0;
+    int score = 0;
+    int blocksDestroyed = 0;
+    bool gameOver = false;
+
+    std::uint64_t countQuietTicks() const;
+};
+
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+
+namespace tapioca {
+
+// Keys for Zobrist hashing of game states. A state's hash is the XOR of the
+// keys of its parts, so a part that changes is updated by XOR-ing its old
+// key out and its new one in. Keys are derived by mixing the part's values
+// instead of being looked up in tables of random numbers, since block
+// positions are not bounded.
+namespace zobrist {
+
+enum Kind : std::uint64_t {
+    RestingBlock = 1,
+    FallingBlock,
+    PlayerPos,
+    PlayerMotion,
+    EggPos,
+    EggMotion,
+    WorldTime,
+    WorldScore,
+    WorldRandom
+};
+
+// splitmix64's finalizer.
+constexpr std::uint64_t mix(std::uint64_t x) {
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+}
+
+constexpr std::uint64_t key(Kind kind, std::int64_t a, std::int64_t b = 0) {
+    return mix(mix(kind * 0x9e3779b97f4a7c15ull ^ static_cast<std::uint64_t>(a)) + static_cast<std::uint64_t>(b));
+}
+
+// Positions and speeds are hashed in units of 1/256 px, which keeps them
+// exact on the shipped board.
+inline std::int64_t quantize(double value) {
+    return std::llround(value * 256.0);
+}
+
+}
+
+}
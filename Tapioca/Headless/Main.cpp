@@ -0,0 +1,1175 @@
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <map>
+#include <string>
+#include <random>
+#include <stdexcept>
+#include <vector>
+#include "../Core/Bot.h"
+#include "../Core/Clock.h"
+#include "../Core/CountAllocations.h"
+#include "../Core/CounterLog.h"
+#include "../Core/EggFlight.h"
+#include "../Core/FixedWorld.h"
+#include "../Core/Observation.h"
+#include "../Core/Profiler.h"
+#include "../Core/Replay.h"
+#include "../Core/Rewind.h"
+#include "../Core/ThreadPool.h"
+#include "../Core/VectorEnv.h"
+#include "../Core/World.h"
+
+namespace {
+
+// Presses a random combination of buttons and holds it for a few ticks,
+// which keeps the player moving and throwing like a (poor) human would.
+class RandomInput {
+public:
+    explicit RandomInput(std::uint64_t seed) : rng(seed) {}
+
+    tapioca::Input next() {
+        if (holdTicks-- <= 0) {
+            const auto bits = rng.below(16);
+            input.left = bits & 1;
+            input.right = bits & 2;
+            input.jump = bits & 4;
+            input.throwEgg = bits & 8;
+            holdTicks = 5 + static_cast<int>(rng.below(16));
+        }
+        return input;
+    }
+
+private:
+    tapioca::Random rng;
+    tapioca::Input input;
+    int holdTicks = 0;
+};
+
+// The hash covers the whole state, including the egg, the player's
+// velocity and the random generator; the fields compared one by one make a
+// collision unlikely to hide a mismatch.
+bool isSameState(const tapioca::World& a, const tapioca::World& b) {
+    if (a.getHash() != b.getHash() ||
+        a.getTick() != b.getTick() || a.isGameOver() != b.isGameOver() || a.getScore() != b.getScore() ||
+        a.getPlayer().getRect().x != b.getPlayer().getRect().x ||
+        a.getPlayer().getRect().y != b.getPlayer().getRect().y ||
+        a.getBlocks().size() != b.getBlocks().size()) {
+        return false;
+    }
+    for (int i = 0; i < a.getBlocks().size(); ++i) {
+        if (a.getBlocks().getPosY(i) != b.getBlocks().getPosY(i) ||
+            a.getBlocks().getColumn(i) != b.getBlocks().getColumn(i)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+struct Options {
+    std::vector<const char*> args;
+    tapioca::FallingMode fallingMode = tapioca::FallingMode::Stepped;
+    // Game i of a run uses seed + i for both the world and its input.
+    std::uint64_t seed = 0;
+    // 0 uses every hardware thread.
+    unsigned threads = 0;
+    // Negative keeps World's default.
+    int blockSpawnInterval = -1;
+    double gravity = tapioca::Board().gravity;
+    double eggSpeed = tapioca::Board().eggSpeed;
+    bool sweptCollision = false;
+    // Choices the bot looks ahead.
+    int depth = tapioca::Bot::defaultDepth;
+
+    int getInt(std::size_t i, int defaultValue) const {
+        return i < args.size() ? std::atoi(args[i]) : defaultValue;
+    }
+
+    long long getLong(std::size_t i, long long defaultValue) const {
+        return i < args.size() ? std::atoll(args[i]) : defaultValue;
+    }
+
+    tapioca::Board makeBoard() const {
+        tapioca::Board board;
+        board.gravity = gravity;
+        board.eggSpeed = eggSpeed;
+        board.sweptCollision = sweptCollision;
+        return board;
+    }
+
+    tapioca::World makeWorld(std::uint64_t worldSeed) const {
+        tapioca::World world(makeBoard(), fallingMode, worldSeed);
+        if (blockSpawnInterval >= 0) {
+            world.setBlockSpawnInterval(blockSpawnInterval);
+        }
+        return world;
+    }
+};
+
+}
+
+// Prints the mean and some percentiles of values, which it sorts.
+void printDistribution(const char* label, std::vector<double>& values) {
+    if (values.empty()) {
+        return;
+    }
+    std::sort(values.begin(), values.end());
+    const auto percentile = [&](double p) {
+        return values[static_cast<std::size_t>(p * (values.size() - 1) + 0.5)];
+    };
+    double sum = 0.0;
+    for (const double value : values) {
+        sum += value;
+    }
+    std::printf("%-17s %10.1f %10.0f %10.0f %10.0f %10.0f %10.0f\n", label, sum / values.size(),
+        values.front(), percentile(0.1), percentile(0.5), percentile(0.9), values.back());
+}
+
+// Plays games with random input on a thread pool, one task per game. Each
+// game depends only on its seed, so the results do not depend on the
+// number of threads.
+int runGames(const Options& options) {
+    const int games = std::max(options.getInt(0, 100), 0);
+    const long long maxTicks = options.getLong(1, 60 * 60 * 10);
+
+    struct Result {
+        std::uint64_t ticks = 0;
+        int score = 0;
+        int blocksDestroyed = 0;
+        double seconds = 0.0;
+    };
+    std::vector<Result> results(games);
+    tapioca::ThreadPool pool(options.threads);
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < games; ++i) {
+        pool.submit([&options, &results, maxTicks, i] {
+            const auto gameStart = std::chrono::steady_clock::now();
+            auto world = options.makeWorld(options.seed + i);
+            RandomInput input(options.seed + i);
+            while (!world.isGameOver() && world.getTick() < static_cast<std::uint64_t>(maxTicks)) {
+                world.step(input.next());
+            }
+            auto& result = results[i];
+            result.ticks = world.getTick();
+            result.score = world.getScore();
+            result.blocksDestroyed = world.getBlocksDestroyed();
+            result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - gameStart).count();
+        });
+    }
+    pool.wait();
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    std::uint64_t totalTicks = 0;
+    double gameSeconds = 0.0;
+    std::vector<double> ticks, scores, blocksDestroyed;
+    for (const auto& result : results) {
+        totalTicks += result.ticks;
+        gameSeconds += result.seconds;
+        ticks.push_back(static_cast<double>(result.ticks));
+        scores.push_back(result.score);
+        blocksDestroyed.push_back(result.blocksDestroyed);
+    }
+
+    const auto board = options.makeBoard();
+    const auto world = options.makeWorld(0);
+    std::printf("games:            %d\n", games);
+    std::printf("threads:          %u\n", pool.size());
+    std::printf("seeds:            %llu-%llu\n", static_cast<unsigned long long>(options.seed),
+        static_cast<unsigned long long>(options.seed + std::max(games, 1) - 1));
+    std::printf("spawn interval:   %d ticks\n", world.getBlockSpawnInterval());
+    std::printf("gravity:          %g\n", board.gravity);
+    std::printf("egg speed:        %g%s\n", board.eggSpeed, board.sweptCollision ? " (swept)" : "");
+    std::printf("%-17s %10s %10s %10s %10s %10s %10s\n", "", "mean", "min", "p10", "p50", "p90", "max");
+    printDistribution("survival ticks", ticks);
+    printDistribution("score", scores);
+    printDistribution("blocks destroyed", blocksDestroyed);
+    std::printf("ticks:            %llu\n", static_cast<unsigned long long>(totalTicks));
+    std::printf("elapsed:          %.3f s\n", elapsed.count());
+    std::printf("ns/tick:          %.1f\n", totalTicks > 0 ? gameSeconds * 1e9 / totalTicks : 0.0);
+    std::printf("realtime ratio:   %.0fx\n", elapsed.count() > 0.0 ? totalTicks / (elapsed.count() * tapioca::ticksPerSecond) : 0.0);
+    return 0;
+}
+
+// Fills a very wide and tall board with blocks and reports the cost of a
+// tick as the block count grows, per block and per falling block. Blocks are never dropped into the player's
+// columns, so the run is not cut short by a crush, and a column only gets a
+// new block once the previous one has fallen clear of the spawn point.
+int runStress(const Options& options) {
+    const int maxBlocks = options.getInt(0, 16000);
+    const int blocksPerTick = options.getInt(1, 4);
+    constexpr int ticksPerSample = 500;
+
+    tapioca::Board board;
+    board.numBlocksX = tapioca::SettledGrid::maxColumns;
+    board.width = board.numBlocksX * tapioca::Block::size;
+    board.height = 320 * tapioca::Block::size + board.floorHeight;
+    tapioca::World world(board, options.fallingMode, options.seed);
+    world.setBlockSpawnInterval(0);
+
+    const auto& playerRect = world.getPlayer().getRect();
+    const double columnWidth = board.width / board.numBlocksX;
+    const int playerFirstColumn = static_cast<int>(playerRect.x / columnWidth);
+    const int playerLastColumn = static_cast<int>(playerRect.right() / columnWidth);
+    // The block last dropped into each column.
+    std::vector<tapioca::BlockId> lastSpawned(board.numBlocksX, tapioca::noBlock);
+    tapioca::Random rng(options.seed);
+
+    std::printf("%10s %10s %12s %12s %12s\n", "blocks", "falling", "ns/tick", "ns/block", "ns/falling");
+    while (!world.isGameOver() && world.getBlocks().size() < maxBlocks) {
+        std::chrono::duration<double, std::nano> elapsed{};
+        // Summed over the ticks of the sample, counted outside the timing.
+        long long fallingTicks = 0;
+        int t = 0;
+        for (; t < ticksPerSample && !world.isGameOver(); ++t) {
+            const auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < blocksPerTick; ++i) {
+                const int c = static_cast<int>(rng.below(board.numBlocksX));
+                if (c >= playerFirstColumn && c <= playerLastColumn) {
+                    continue;
+                }
+                const int last = world.getBlocks().find(lastSpawned[c]);
+                if (last < 0 || world.getBlocks().getPosY(last) >= 0.0) {
+                    lastSpawned[c] = world.spawnBlock(c);
+                }
+            }
+            world.step(tapioca::Input());
+            elapsed += std::chrono::steady_clock::now() - start;
+            for (int i = 0; i < world.getBlocks().size(); ++i) {
+                fallingTicks += world.getBlocks().isMoving(i);
+            }
+        }
+        const int numBlocks = world.getBlocks().size();
+        const double nsPerTick = elapsed.count() / std::max(t, 1);
+        std::printf("%10d %10.0f %12.1f %12.2f %12.2f\n", numBlocks, static_cast<double>(fallingTicks) / std::max(t, 1),
+            nsPerTick, nsPerTick / std::max(numBlocks, 1), elapsed.count() / std::max(fallingTicks, 1ll));
+    }
+    return 0;
+}
+
+// Lets the blocks pile up on an idle player until the game ends, first
+// stepping every tick and then with World::fastForward, and checks that
+// both arrive at the same state.
+int runFastForward(const Options& options) {
+    const int games = options.getInt(0, 100);
+    const long long maxTicks = options.getLong(1, 60 * 60 * 10);
+
+    std::chrono::duration<double> steppedTime{}, fastForwardTime{};
+    int mismatches = 0;
+    for (int i = 0; i < games; ++i) {
+        tapioca::World stepped(tapioca::Board(), tapioca::FallingMode::Analytic, options.seed + i);
+        auto fastForwarded = stepped;
+
+        auto start = std::chrono::steady_clock::now();
+        while (!stepped.isGameOver() && stepped.getTick() < static_cast<std::uint64_t>(maxTicks)) {
+            stepped.step(tapioca::Input());
+        }
+        steppedTime += std::chrono::steady_clock::now() - start;
+
+        start = std::chrono::steady_clock::now();
+        fastForwarded.fastForward(stepped.getTick());
+        fastForwardTime += std::chrono::steady_clock::now() - start;
+
+        if (!isSameState(fastForwarded, stepped)) {
+            ++mismatches;
+        }
+    }
+
+    std::printf("games:        %d\n", games);
+    std::printf("stepped:      %.3f s\n", steppedTime.count());
+    std::printf("fast-forward: %.3f s\n", fastForwardTime.count());
+    std::printf("mismatches:   %d\n", mismatches);
+    return mismatches == 0 ? 0 : 1;
+}
+
+// Drives the same game through FixedStepClock at several display rates and
+// checks that each arrives at the same tick, and so the same state, after
+// the same amount of simulated real time.
+int runFrameRates(const Options& options) {
+    const int seconds = options.getInt(0, 600);
+    const std::uint64_t expectedTicks = static_cast<std::uint64_t>(seconds) * tapioca::ticksPerSecond;
+
+    // Without falling blocks the game lasts the whole run.
+    tapioca::World reference(tapioca::Board(), options.fallingMode, options.seed);
+    reference.setBlockSpawnInterval(0);
+    auto initial = reference;
+    RandomInput referenceInput(options.seed);
+    while (!reference.isGameOver() && reference.getTick() < expectedTicks) {
+        reference.step(referenceInput.next());
+    }
+
+    int mismatches = 0;
+    std::printf("%6s %10s %8s\n", "hz", "ticks", "state");
+    for (const int hz : { 30, 60, 144, 240 }) {
+        auto world = initial;
+        RandomInput input(options.seed);
+        tapioca::FixedStepClock clock;
+        for (long long frame = 0; frame < static_cast<long long>(seconds) * hz; ++frame) {
+            const int ticks = clock.advance(1.0 / hz);
+            for (int i = 0; i < ticks && !world.isGameOver(); ++i) {
+                world.step(input.next());
+            }
+        }
+        // Rounding may leave the last tick in the accumulator.
+        if (!world.isGameOver() && world.getTick() + 1 == reference.getTick()) {
+            world.step(input.next());
+        }
+        const bool same = isSameState(world, reference);
+        mismatches += !same;
+        std::printf("%6d %10llu %8s\n", hz, static_cast<unsigned long long>(world.getTick()),
+            same ? "same" : "DIFFERS");
+    }
+    return mismatches == 0 ? 0 : 1;
+}
+
+// Steps a VectorEnv with random actions and reports its throughput. The
+// totals are the same for any --threads value.
+int runVectorEnv(const Options& options) {
+    const int numEnvs = std::max(options.getInt(0, 256), 1);
+    const int steps = options.getInt(1, 10000);
+
+    tapioca::VectorEnv env(numEnvs, options.seed, options.makeBoard(), options.fallingMode, options.threads);
+    std::vector<RandomInput> inputs;
+    for (int i = 0; i < numEnvs; ++i) {
+        inputs.emplace_back(options.seed + i);
+    }
+    std::vector<std::uint8_t> actions(numEnvs);
+    long long episodes = 0;
+    double totalReward = 0.0;
+
+    const auto start = std::chrono::steady_clock::now();
+    for (int t = 0; t < steps; ++t) {
+        for (int i = 0; i < numEnvs; ++i) {
+            actions[i] = inputs[i].next().toBits();
+        }
+        env.step(actions.data());
+        const auto& batch = env.getBatch();
+        for (int i = 0; i < numEnvs; ++i) {
+            totalReward += batch.reward[i];
+            episodes += batch.done[i];
+        }
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    const double envSteps = static_cast<double>(numEnvs) * steps;
+
+    std::printf("envs:        %d\n", numEnvs);
+    std::printf("steps:       %d\n", steps);
+    std::printf("episodes:    %lld\n", episodes);
+    std::printf("reward:      %.0f\n", totalReward);
+    std::printf("elapsed:     %.3f s\n", elapsed.count());
+    std::printf("env steps/s: %.0f\n", elapsed.count() > 0.0 ? envSteps / elapsed.count() : 0.0);
+    return 0;
+}
+
+// Plays games with random input and times encoding an observation of every
+// tick into the same buffer.
+int runObserve(const Options& options) {
+    const int games = std::max(options.getInt(0, 100), 1);
+    const long long maxTicks = options.getLong(1, 60 * 60 * 10);
+
+    const tapioca::ObservationEncoder encoder(options.makeBoard());
+    std::vector<float> observation(encoder.size());
+    std::chrono::duration<double, std::nano> encodeTime{};
+    long long observations = 0;
+    double checksum = 0.0;
+    for (int i = 0; i < games; ++i) {
+        auto world = options.makeWorld(options.seed + i);
+        RandomInput input(options.seed + i);
+        while (!world.isGameOver() && world.getTick() < static_cast<std::uint64_t>(maxTicks)) {
+            world.step(input.next());
+            const auto start = std::chrono::steady_clock::now();
+            encoder.encode(world, observation.data());
+            encodeTime += std::chrono::steady_clock::now() - start;
+            ++observations;
+            checksum += observation[0];
+        }
+    }
+
+    std::printf("floats/observation: %d\n", encoder.size());
+    std::printf("observations:       %lld\n", observations);
+    std::printf("checksum:           %.3f\n", checksum);
+    std::printf("ns/observation:     %.1f\n", observations > 0 ? encodeTime.count() / observations : 0.0);
+    return 0;
+}
+
+// Plays games with random input, regularly saving a snapshot, playing on,
+// restoring it and playing the same ticks again. Checks that both runs end
+// in byte-identical snapshots and that the restored blocks are found by
+// their ids, and times save and restore.
+int runSnapshot(const Options& options) {
+    const int games = std::max(options.getInt(0, 100), 1);
+    const long long maxTicks = options.getLong(1, 60 * 60 * 10);
+    constexpr int replayTicks = 60;
+
+    tapioca::Snapshot start, first, second;
+    std::vector<tapioca::Input> inputs;
+    std::chrono::duration<double, std::nano> saveTime{}, restoreTime{};
+    long long saves = 0, restores = 0;
+    std::size_t bytes = 0;
+    int mismatches = 0;
+    for (int i = 0; i < games; ++i) {
+        auto world = options.makeWorld(options.seed + i);
+        RandomInput input(options.seed + i);
+        while (!world.isGameOver() && world.getTick() < static_cast<std::uint64_t>(maxTicks)) {
+            auto t0 = std::chrono::steady_clock::now();
+            world.save(start);
+            saveTime += std::chrono::steady_clock::now() - t0;
+            ++saves;
+            bytes = std::max(bytes, start.size());
+
+            inputs.clear();
+            for (int t = 0; t < replayTicks && !world.isGameOver(); ++t) {
+                inputs.push_back(input.next());
+                world.step(inputs.back());
+            }
+            world.save(first);
+
+            t0 = std::chrono::steady_clock::now();
+            world.restore(start);
+            restoreTime += std::chrono::steady_clock::now() - t0;
+            ++restores;
+            const auto& blocks = world.getBlocks();
+            for (int b = 0; b < blocks.size(); ++b) {
+                mismatches += blocks.find(blocks.getId(b)) != b;
+            }
+            for (const auto& next : inputs) {
+                world.step(next);
+            }
+            world.save(second);
+            if (first.size() != second.size() || std::memcmp(first.data(), second.data(), first.size()) != 0) {
+                ++mismatches;
+            }
+        }
+    }
+
+    std::printf("snapshots:      %lld\n", saves);
+    std::printf("max bytes:      %zu\n", bytes);
+    std::printf("ns/save:        %.1f\n", saves > 0 ? saveTime.count() / saves : 0.0);
+    std::printf("ns/restore:     %.1f\n", restores > 0 ? restoreTime.count() / restores : 0.0);
+    std::printf("mismatches:     %d\n", mismatches);
+    return mismatches == 0 ? 0 : 1;
+}
+
+// Throws eggs from random points at a single block, resting or falling,
+// and compares the hit tick EggFlight predicts, from its tables and in
+// closed form, with stepping the egg for real.
+int runTrajectory(const Options& options) {
+    const int throws = std::max(options.getInt(0, 100000), 1);
+    const tapioca::Board board;
+    constexpr int restingTicks = 200;
+    // Falling blocks must not land during the flight.
+    const int maxFallingTicks = static_cast<int>(
+        (board.floorY() - 2 * tapioca::Block::size) / tapioca::Block::fallingSpeed) - tapioca::EggFlight::maxTicks;
+
+    struct Throw {
+        tapioca::Vec2 start;
+        bool right;
+        tapioca::Rect target;
+        double fallSpeed;
+        int stepped;
+    };
+    std::vector<Throw> cases;
+    tapioca::Random rng(options.seed);
+    std::chrono::duration<double, std::nano> stepTime{};
+    int hits = 0;
+    for (int i = 0; i < throws; ++i) {
+        const int column = static_cast<int>(rng.below(board.numBlocksX));
+        const bool resting = rng.below(4) == 0;
+        const int blockTicks = resting ? restingTicks : static_cast<int>(rng.below(maxFallingTicks));
+        // Half the throws from whole pixels, where the tables apply.
+        tapioca::Vec2 pos(rng.below(460) - 30.0, rng.below(1200) / 2.0 - 100.0);
+        if (rng.below(2) == 0) {
+            pos.x += rng.below(1000) / 1000.0;
+        }
+        const bool right = rng.below(2) == 0;
+
+        tapioca::BlockField blocks(board, tapioca::FallingMode::Stepped);
+        blocks.spawn(column, 0);
+        for (int t = 1; t <= blockTicks + 1; ++t) {
+            blocks.update(t);
+        }
+        const auto target = blocks.getRect(0);
+
+        const auto t0 = std::chrono::steady_clock::now();
+        tapioca::Egg egg(pos, right, board);
+        int stepped = -1;
+        for (int n = 0; !egg.isExploding(); ++n) {
+            if (n > 0) {
+                blocks.update(blockTicks + 1 + n);
+            }
+            if (egg.update(blocks, board) >= 0) {
+                stepped = n;
+            }
+        }
+        stepTime += std::chrono::steady_clock::now() - t0;
+        hits += stepped >= 0;
+        cases.push_back({ tapioca::Egg::getStartPos(pos), right, target, resting ? 0.0 : tapioca::Block::fallingSpeed, stepped });
+    }
+
+    int tableMismatches = 0, solverMismatches = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    for (const auto& c : cases) {
+        tableMismatches += tapioca::EggFlight::getHitTick(c.start, c.right, c.target, c.fallSpeed, board) != c.stepped;
+    }
+    const std::chrono::duration<double, std::nano> tableTime = std::chrono::steady_clock::now() - t0;
+    t0 = std::chrono::steady_clock::now();
+    for (const auto& c : cases) {
+        solverMismatches += tapioca::EggFlight::solveHitTick(c.start, c.right, c.target, c.fallSpeed, board) != c.stepped;
+    }
+    const std::chrono::duration<double, std::nano> solverTime = std::chrono::steady_clock::now() - t0;
+
+    std::printf("throws:             %d\n", throws);
+    std::printf("hits:               %d\n", hits);
+    std::printf("ns/table lookup:    %.1f\n", tableTime.count() / throws);
+    std::printf("ns/solve:           %.1f\n", solverTime.count() / throws);
+    std::printf("ns/step:            %.1f\n", stepTime.count() / throws);
+    std::printf("table mismatches:   %d\n", tableMismatches);
+    std::printf("solver mismatches:  %d\n", solverMismatches);
+    return tableMismatches == 0 && solverMismatches == 0 ? 0 : 1;
+}
+
+// Plays random games in both falling modes side by side and checks every
+// tick that the incrementally kept Zobrist hash equals the one computed
+// from scratch and that both modes hash alike. Times both ways of hashing.
+int runHash(const Options& options) {
+    const int games = std::max(options.getInt(0, 100), 1);
+    const long long maxTicks = options.getLong(1, 60 * 60 * 10);
+
+    std::chrono::duration<double, std::nano> incrementalTime{}, fullTime{};
+    long long ticks = 0;
+    int stale = 0, modeMismatches = 0;
+    std::uint64_t sum = 0;
+    for (int i = 0; i < games; ++i) {
+        auto modeOptions = options;
+        modeOptions.fallingMode = tapioca::FallingMode::Stepped;
+        auto stepped = modeOptions.makeWorld(options.seed + i);
+        modeOptions.fallingMode = tapioca::FallingMode::Analytic;
+        auto analytic = modeOptions.makeWorld(options.seed + i);
+        RandomInput input(options.seed + i);
+        while (!stepped.isGameOver() && stepped.getTick() < static_cast<std::uint64_t>(maxTicks)) {
+            const auto next = input.next();
+            stepped.step(next);
+            analytic.step(next);
+            ++ticks;
+
+            auto t0 = std::chrono::steady_clock::now();
+            const auto hash = analytic.getHash();
+            incrementalTime += std::chrono::steady_clock::now() - t0;
+            t0 = std::chrono::steady_clock::now();
+            const auto full = analytic.computeHash();
+            fullTime += std::chrono::steady_clock::now() - t0;
+            sum += hash + full;
+
+            if (hash != full || stepped.getHash() != stepped.computeHash()) {
+                ++stale;
+            }
+            if (hash != stepped.getHash()) {
+                ++modeMismatches;
+            }
+        }
+    }
+
+    std::printf("ticks:            %lld\n", ticks);
+    std::printf("ns/getHash:       %.1f\n", ticks > 0 ? incrementalTime.count() / ticks : 0.0);
+    std::printf("ns/computeHash:   %.1f\n", ticks > 0 ? fullTime.count() / ticks : 0.0);
+    std::printf("stale hashes:     %d\n", stale);
+    std::printf("mode mismatches:  %d\n", modeMismatches);
+    // Printed so the hashing is not optimized away.
+    std::printf("checksum:         %016llx\n", static_cast<unsigned long long>(sum));
+    return stale == 0 && modeMismatches == 0 ? 0 : 1;
+}
+
+// Records random games into a RewindBuffer and times it. At the end of
+// each game every state still held is restored and compared with a full
+// snapshot taken when it was recorded.
+int runRewind(const Options& options) {
+    const int games = std::max(options.getInt(0, 100), 1);
+    const long long maxTicks = options.getLong(1, 60 * 60 * 10);
+    const int seconds = std::max(options.getInt(2, 10), 1);
+    const std::size_t kilobytes = std::max(options.getInt(3, 4096), 1);
+
+    tapioca::RewindBuffer rewind(tapioca::secondsToTicks(seconds), kilobytes * 1024);
+    std::vector<tapioca::Snapshot> reference;
+    tapioca::Snapshot restored;
+    std::chrono::duration<double, std::nano> recordTime{};
+    long long records = 0, checks = 0;
+    std::size_t maxUsed = 0;
+    int mismatches = 0;
+    for (int i = 0; i < games; ++i) {
+        auto world = options.makeWorld(options.seed + i);
+        RandomInput input(options.seed + i);
+        rewind.clear();
+        reference.clear();
+        while (true) {
+            const auto start = std::chrono::steady_clock::now();
+            rewind.record(world);
+            recordTime += std::chrono::steady_clock::now() - start;
+            ++records;
+            reference.emplace_back();
+            world.save(reference.back());
+            if (world.isGameOver() || world.getTick() >= static_cast<std::uint64_t>(maxTicks)) {
+                break;
+            }
+            world.step(input.next());
+        }
+        maxUsed = std::max(maxUsed, rewind.getUsedBytes());
+
+        for (int f = 0; f < rewind.size(); ++f) {
+            rewind.restore(f, world);
+            world.save(restored);
+            const auto& expected = reference[rewind.getTick(f)];
+            if (expected.size() != restored.size() || std::memcmp(expected.data(), restored.data(), expected.size()) != 0) {
+                ++mismatches;
+            }
+            ++checks;
+        }
+    }
+
+    std::printf("states recorded: %lld\n", records);
+    std::printf("states checked:  %lld\n", checks);
+    std::printf("max bytes used:  %zu\n", maxUsed);
+    std::printf("ns/record:       %.1f\n", records > 0 ? recordTime.count() / records : 0.0);
+    std::printf("mismatches:      %d\n", mismatches);
+    return mismatches == 0 ? 0 : 1;
+}
+
+// Lets the bot play games one after another, searching on all threads, and
+// times it. Every game is recorded and played back at the end as a check
+// that the search left no trace in the game it was playing.
+int runBot(const Options& options) {
+    const int games = std::max(options.getInt(0, 10), 1);
+    const long long maxTicks = options.getLong(1, 60 * 60 * 10);
+
+    tapioca::Bot bot(options.depth, options.threads);
+    std::vector<double> ticks, scores;
+    long long desyncs = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < games; ++i) {
+        auto world = options.makeWorld(options.seed + i);
+        tapioca::Replay replay(world);
+        bot.reset();
+        while (!world.isGameOver() && world.getTick() < static_cast<std::uint64_t>(maxTicks)) {
+            const auto input = bot.decide(world);
+            replay.record(input);
+            world.step(input);
+        }
+        replay.finish(world);
+
+        auto check = replay.makeWorld();
+        for (tapioca::Replay::Cursor cursor(replay); !cursor.atEnd();) {
+            check.step(cursor.next());
+        }
+        if (!isSameState(world, check)) {
+            ++desyncs;
+        }
+        ticks.push_back(static_cast<double>(world.getTick()));
+        scores.push_back(world.getScore());
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    std::printf("%-17s %10s %10s %10s %10s %10s %10s\n", "", "mean", "min", "p10", "p50", "p90", "max");
+    printDistribution("ticks survived", ticks);
+    printDistribution("score", scores);
+    std::printf("positions:        %llu\n", static_cast<unsigned long long>(bot.getNodes()));
+    std::printf("positions/s:      %.0f\n", bot.getNodes() / elapsed.count());
+    std::printf("table hits:       %.1f%%\n", bot.getNodes() > 0 ? 100.0 * bot.getTableHits() / bot.getNodes() : 0.0);
+    std::printf("desyncs:          %lld\n", desyncs);
+    return desyncs == 0 ? 0 : 1;
+}
+
+// Plays the same random games with ever faster eggs, testing only where
+// the egg is and also the path it took, and compares the blocks destroyed
+// and the cost of a tick.
+int runSweep(const Options& options) {
+    const int games = std::max(options.getInt(0, 100), 1);
+    const long long maxTicks = options.getLong(1, 60 * 60 * 10);
+    const double eggSpeeds[] = { 20.0, 40.0, 80.0, 160.0 };
+
+    std::printf("%10s %10s %18s %10s\n", "egg speed", "test", "blocks destroyed", "ns/tick");
+    for (const double eggSpeed : eggSpeeds) {
+        for (const bool swept : { false, true }) {
+            auto sweepOptions = options;
+            sweepOptions.eggSpeed = eggSpeed;
+            sweepOptions.sweptCollision = swept;
+            std::chrono::duration<double, std::nano> elapsed{};
+            long long ticks = 0, blocksDestroyed = 0;
+            for (int i = 0; i < games; ++i) {
+                auto world = sweepOptions.makeWorld(options.seed + i);
+                RandomInput input(options.seed + i);
+                const auto start = std::chrono::steady_clock::now();
+                while (!world.isGameOver() && world.getTick() < static_cast<std::uint64_t>(maxTicks)) {
+                    world.step(input.next());
+                }
+                elapsed += std::chrono::steady_clock::now() - start;
+                ticks += static_cast<long long>(world.getTick());
+                blocksDestroyed += world.getBlocksDestroyed();
+            }
+            std::printf("%10g %10s %18.1f %10.1f\n", eggSpeed, swept ? "swept" : "discrete",
+                static_cast<double>(blocksDestroyed) / games, ticks > 0 ? elapsed.count() / ticks : 0.0);
+        }
+    }
+    return 0;
+}
+
+// Whether a fixed-point game is in exactly the state of a floating-point
+// one. Every Fixed is a double, so the comparisons are exact.
+bool isSameState(const tapioca::FixedWorld& a, const tapioca::World& b) {
+    const auto& player = a.getPlayer();
+    const auto& other = b.getPlayer();
+    if (a.getTick() != b.getTick() || a.isGameOver() != b.isGameOver() || a.getScore() != b.getScore() ||
+        a.getBlocksDestroyed() != b.getBlocksDestroyed() ||
+        player.rect.x.toDouble() != other.getRect().x || player.rect.y.toDouble() != other.getRect().y ||
+        player.vy.toDouble() != other.getVelocityY() || player.egg.has_value() != other.getEgg().has_value() ||
+        a.getNumBlocks() != b.getBlocks().size()) {
+        return false;
+    }
+    if (player.egg && (player.egg->rect.x.toDouble() != other.getEgg()->getRect().x ||
+        player.egg->rect.y.toDouble() != other.getEgg()->getRect().y)) {
+        return false;
+    }
+    const auto& blocks = b.getBlocks();
+    for (int i = 0; i < a.getNumBlocks(); ++i) {
+        if (a.getBlockY(i).toDouble() != blocks.getPosY(i) || a.getBlockColumn(i) != blocks.getColumn(i) ||
+            a.isBlockMoving(i) != blocks.isMoving(i)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Plays the same random games in fixed and in floating point, compares the
+// two after every tick and times both. A checksum of the fixed-point games
+// is printed for comparing builds.
+int runFixed(const Options& options) {
+    const int games = std::max(options.getInt(0, 100), 1);
+    const long long maxTicks = options.getLong(1, 60 * 60 * 10);
+
+    // Timed on their own first, so neither pays for the comparison.
+    std::chrono::duration<double, std::nano> floatTime{}, fixedTime{};
+    long long floatTicks = 0, fixedTicks = 0;
+    std::uint64_t checksum = 0;
+    for (int i = 0; i < games; ++i) {
+        auto world = options.makeWorld(options.seed + i);
+        RandomInput input(options.seed + i);
+        auto start = std::chrono::steady_clock::now();
+        while (!world.isGameOver() && world.getTick() < static_cast<std::uint64_t>(maxTicks)) {
+            world.step(input.next());
+        }
+        floatTime += std::chrono::steady_clock::now() - start;
+        floatTicks += static_cast<long long>(world.getTick());
+
+        tapioca::FixedWorld fixed(options.makeBoard(), options.seed + i);
+        if (options.blockSpawnInterval >= 0) {
+            fixed.setBlockSpawnInterval(options.blockSpawnInterval);
+        }
+        RandomInput fixedInput(options.seed + i);
+        start = std::chrono::steady_clock::now();
+        while (!fixed.isGameOver() && fixed.getTick() < static_cast<std::uint64_t>(maxTicks)) {
+            fixed.step(fixedInput.next());
+        }
+        fixedTime += std::chrono::steady_clock::now() - start;
+        fixedTicks += static_cast<long long>(fixed.getTick());
+        checksum = checksum * 31 + fixed.hash();
+    }
+
+    int diverged = 0;
+    long long firstDivergence = -1;
+    for (int i = 0; i < games; ++i) {
+        auto modeOptions = options;
+        modeOptions.fallingMode = tapioca::FallingMode::Stepped;
+        auto world = modeOptions.makeWorld(options.seed + i);
+        tapioca::FixedWorld fixed(options.makeBoard(), options.seed + i);
+        if (options.blockSpawnInterval >= 0) {
+            fixed.setBlockSpawnInterval(options.blockSpawnInterval);
+        }
+        RandomInput input(options.seed + i);
+        while (!world.isGameOver() && world.getTick() < static_cast<std::uint64_t>(maxTicks)) {
+            const auto next = input.next();
+            world.step(next);
+            fixed.step(next);
+            if (!isSameState(fixed, world)) {
+                ++diverged;
+                if (firstDivergence < 0 || static_cast<long long>(world.getTick()) < firstDivergence) {
+                    firstDivergence = static_cast<long long>(world.getTick());
+                }
+                break;
+            }
+        }
+    }
+
+    std::printf("games:            %d\n", games);
+    std::printf("ns/tick double:   %.1f\n", floatTicks > 0 ? floatTime.count() / floatTicks : 0.0);
+    std::printf("ns/tick fixed:    %.1f\n", fixedTicks > 0 ? fixedTime.count() / fixedTicks : 0.0);
+    std::printf("checksum:         %016llx\n", static_cast<unsigned long long>(checksum));
+    std::printf("diverged games:   %d\n", diverged);
+    if (diverged > 0) {
+        std::printf("first divergence: tick %lld\n", firstDivergence);
+    }
+    return diverged == 0 ? 0 : 1;
+}
+
+// Plays random games on all threads and a few bot decisions with the
+// timing zones compiled in, writes them as a Chrome trace and prints the
+// time spent in each zone. Only the last Profiler::ringSize zones of each
+// thread are kept.
+int runProfile(const Options& options) {
+    if (!tapioca::Profiler::enabled) {
+        std::fprintf(stderr, "profile: built without zones; configure with -DTAPIOCA_PROFILE=ON\n");
+        return 1;
+    }
+    const int games = std::max(options.getInt(0, 16), 1);
+    const long long maxTicks = options.getLong(1, 60 * 60);
+    const std::string path = options.args.size() > 2 ? options.args[2] : "trace.json";
+
+    tapioca::Profiler::clear();
+    tapioca::ThreadPool pool(options.threads);
+    for (int i = 0; i < games; ++i) {
+        pool.submit([&options, maxTicks, i] {
+            auto world = options.makeWorld(options.seed + i);
+            RandomInput input(options.seed + i);
+            while (!world.isGameOver() && world.getTick() < static_cast<std::uint64_t>(maxTicks)) {
+                world.step(input.next());
+            }
+        });
+    }
+    pool.wait();
+    {
+        tapioca::Bot bot(options.depth, options.threads);
+        auto world = options.makeWorld(options.seed);
+        for (int t = 0; t < 10 * tapioca::Bot::actionTicks && !world.isGameOver(); ++t) {
+            world.step(bot.decide(world));
+        }
+    }
+
+    if (!tapioca::Profiler::writeChromeTrace(path)) {
+        std::fprintf(stderr, "profile: cannot write %s\n", path.c_str());
+        return 1;
+    }
+    struct Total {
+        long long count = 0;
+        std::uint64_t nanoseconds = 0;
+    };
+    std::map<std::string, Total> totals;
+    const auto events = tapioca::Profiler::collect();
+    for (const auto& event : events) {
+        auto& total = totals[event.name];
+        ++total.count;
+        total.nanoseconds += event.duration;
+    }
+    std::printf("%-20s %10s %12s %10s\n", "zone", "count", "total ms", "mean ns");
+    for (const auto& zone : totals) {
+        std::printf("%-20s %10lld %12.3f %10.1f\n", zone.first.c_str(), zone.second.count,
+            zone.second.nanoseconds / 1e6, static_cast<double>(zone.second.nanoseconds) / zone.second.count);
+    }
+    std::printf("trace:                %s (%zu zones)\n", path.c_str(), events.size());
+    return 0;
+}
+
+// Plays random games on one thread, logs the work done in every tick and
+// saves the log. The counts depend only on the seeds and the code, not on
+// the machine, so they can be compared between versions.
+int runCounters(const Options& options) {
+    if (!tapioca::Counters::enabled) {
+        std::fprintf(stderr, "counters: configure with -DTAPIOCA_COUNTERS=ON\n");
+        return 1;
+    }
+    const int games = std::max(options.getInt(0, 10), 1);
+    const long long maxTicks = options.getLong(1, 60 * 60 * 10);
+    const std::string path = options.args.size() > 2 ? options.args[2] : "counters.csv";
+
+    tapioca::CounterLog log;
+    std::uint64_t frame = 0;
+    for (int i = 0; i < games; ++i) {
+        auto world = options.makeWorld(options.seed + i);
+        RandomInput input(options.seed + i);
+        while (!world.isGameOver() && world.getTick() < static_cast<std::uint64_t>(maxTicks)) {
+            const auto next = input.next();
+            const auto before = tapioca::threadCounters;
+            world.step(next);
+            log.add(frame++, tapioca::threadCounters - before);
+        }
+    }
+    log.save(path);
+
+    std::printf("%-20s %14s %10s\n", "count", "total", "per tick");
+    log.getTotal().forEach([&](const char* name, std::uint64_t value) {
+        std::printf("%-20s %14llu %10.2f\n", name, static_cast<unsigned long long>(value),
+            frame > 0 ? static_cast<double>(value) / frame : 0.0);
+    });
+    std::printf("ticks:               %llu\n", static_cast<unsigned long long>(frame));
+    std::printf("saved:               %s\n", path.c_str());
+    return 0;
+}
+
+// Plays games the way the Playing scene does, recording every tick into a
+// replay and a shared rewind buffer, and counts the heap allocations made
+// after a warm-up of the first ticks of the first game. Then steps a
+// VectorEnv, whose environments start their next games in place, for as
+// many ticks. Fails if there are any: a steady-state tick must not
+// allocate, whether or not a game ends in it.
+int runAllocations(const Options& options) {
+    const int games = std::max(options.getInt(0, 20), 1);
+    const long long maxTicks = options.getLong(1, 60 * 60 * 10);
+    const long long warmUpTicks = options.getLong(2, 60);
+    constexpr int numEnvs = 16;
+
+    tapioca::RewindBuffer rewind(tapioca::secondsToTicks(10), 4 << 20);
+    std::uint64_t allocations = 0, ticks = 0;
+    for (int i = 0; i < games; ++i) {
+        auto world = options.makeWorld(options.seed + i);
+        tapioca::Replay replay(world);
+        RandomInput input(options.seed + i);
+        rewind.clear();
+        rewind.record(world);
+        while (!world.isGameOver() && world.getTick() < static_cast<std::uint64_t>(maxTicks)) {
+            const bool counted = i > 0 || world.getTick() >= static_cast<std::uint64_t>(warmUpTicks);
+            const auto before = tapioca::threadCounters.allocations;
+            const auto next = input.next();
+            replay.record(next);
+            world.step(next);
+            rewind.record(world);
+            if (counted) {
+                allocations += tapioca::threadCounters.allocations - before;
+                ++ticks;
+            }
+        }
+    }
+
+    // On one thread, as threadCounters only sees the thread it belongs to.
+    tapioca::VectorEnv env(numEnvs, options.seed, options.makeBoard(), options.fallingMode);
+    std::vector<RandomInput> inputs;
+    for (int i = 0; i < numEnvs; ++i) {
+        inputs.emplace_back(options.seed + i);
+    }
+    std::vector<std::uint8_t> actions(numEnvs);
+    std::uint64_t envAllocations = 0, envSteps = 0, episodes = 0;
+    for (std::uint64_t t = 0; t * numEnvs < ticks; ++t) {
+        for (int i = 0; i < numEnvs; ++i) {
+            actions[i] = inputs[i].next().toBits();
+        }
+        const auto before = tapioca::threadCounters.allocations;
+        env.step(actions.data());
+        envAllocations += tapioca::threadCounters.allocations - before;
+        envSteps += numEnvs;
+        episodes += std::count(env.getBatch().done.begin(), env.getBatch().done.end(), 1);
+    }
+
+    std::printf("ticks counted:     %llu\n", static_cast<unsigned long long>(ticks));
+    std::printf("allocations:       %llu\n", static_cast<unsigned long long>(allocations));
+    std::printf("env ticks counted: %llu (%llu games ended)\n", static_cast<unsigned long long>(envSteps),
+        static_cast<unsigned long long>(episodes));
+    std::printf("env allocations:   %llu\n", static_cast<unsigned long long>(envAllocations));
+    return allocations == 0 && envAllocations == 0 ? 0 : 1;
+}
+
+// Plays one game with random input and saves it as a replay.
+int runRecord(const Options& options) {
+    if (options.args.empty()) {
+        std::fprintf(stderr, "record: missing replay file\n");
+        return 1;
+    }
+    const long long maxTicks = options.getLong(1, 60 * 60 * 10);
+
+    auto world = options.makeWorld(options.seed);
+    tapioca::Replay replay(world);
+    RandomInput input(options.seed);
+    while (!world.isGameOver() && world.getTick() < static_cast<std::uint64_t>(maxTicks)) {
+        const auto next = input.next();
+        replay.record(next);
+        world.step(next);
+    }
+    replay.finish(world);
+    replay.save(options.args[0]);
+
+    std::printf("ticks: %llu\n", static_cast<unsigned long long>(world.getTick()));
+    std::printf("score: %d\n", world.getScore());
+    std::printf("bytes: %zu\n", replay.serialize().size());
+    return 0;
+}
+
+// Whether deserialize rejects the replay's bytes with the board header
+// corrupted in each of a few ways, rather than building a World from it.
+bool rejectsMalformedBoards(const tapioca::Replay& replay) {
+    // Byte offsets of numBlocksX (u16) and height (f64) in the file.
+    const std::size_t numBlocksXAt = 6;
+    const std::size_t heightAt = 16;
+    const auto put = [](std::vector<std::uint8_t>& data, std::size_t at, std::uint64_t value, int size) {
+        for (int i = 0; i < size; ++i) {
+            data[at + i] = static_cast<std::uint8_t>(value >> (8 * i));
+        }
+    };
+    const std::uint64_t quietNaN = 0x7ff8000000000000ull;
+    struct Corruption {
+        std::size_t at;
+        std::uint64_t value;
+        int size;
+    };
+    const Corruption corruptions[] = {
+        { numBlocksXAt, 0, 2 },
+        { numBlocksXAt, tapioca::SettledGrid::maxColumns + 1, 2 },
+        { heightAt, quietNaN, 8 },
+    };
+    for (const auto& corruption : corruptions) {
+        auto data = replay.serialize();
+        put(data, corruption.at, corruption.value, corruption.size);
+        try {
+            tapioca::Replay::deserialize(data);
+            return false;
+        } catch (const std::runtime_error&) {
+        }
+    }
+    return true;
+}
+
+// Plays a replay back, repeatedly for timing, and checks that it ends with
+// the recorded score and that corrupt copies of it are rejected.
+int runReplay(const Options& options) {
+    if (options.args.empty()) {
+        std::fprintf(stderr, "replay: missing replay file\n");
+        return 1;
+    }
+    const int repeats = std::max(options.getInt(1, 1), 1);
+    const auto replay = tapioca::Replay::load(options.args[0]);
+
+    tapioca::World world;
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < repeats; ++i) {
+        world = replay.makeWorld();
+        for (tapioca::Replay::Cursor cursor(replay); !cursor.atEnd();) {
+            world.step(cursor.next());
+        }
+    }
+    const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+
+    const bool same = world.getTick() == replay.getNumTicks() && world.getScore() == replay.getScore();
+    std::printf("seed:    %llu\n", static_cast<unsigned long long>(replay.getSeed()));
+    std::printf("ticks:   %llu\n", static_cast<unsigned long long>(world.getTick()));
+    std::printf("score:   %d (recorded %d)\n", world.getScore(), replay.getScore());
+    std::printf("ns/tick: %.1f\n", replay.getNumTicks() > 0 ? elapsed.count() / repeats / replay.getNumTicks() : 0.0);
+    std::printf("%s\n", same ? "in sync" : "DESYNC");
+    const bool rejects = rejectsMalformedBoards(replay);
+    std::printf("malformed boards: %s\n", rejects ? "rejected" : "ACCEPTED");
+    return same && rejects ? 0 : 1;
+}
+
+void printUsage() {
+    std::printf(
+        "usage: TapiocaHeadless [run] [games] [max ticks] [--analytic] [--seed n] [--threads n]\n"
+        "                       [--spawn-interval ticks] [--gravity g] [--egg-speed v] [--swept]\n"
+        "       TapiocaHeadless stress [max blocks] [blocks per tick] [--analytic] [--seed n]\n"
+        "       TapiocaHeadless fastforward [games] [max ticks] [--seed n]\n"
+        "       TapiocaHeadless vecenv [envs] [steps] [--analytic] [--seed n] [--threads n]\n"
+        "       TapiocaHeadless observe [games] [max ticks] [--analytic] [--seed n]\n"
+        "       TapiocaHeadless snapshot [games] [max ticks] [--analytic] [--seed n]\n"
+        "       TapiocaHeadless trajectory [throws] [--seed n]\n"
+        "       TapiocaHeadless hash [games] [max ticks] [--seed n]\n"
+        "       TapiocaHeadless rewind [games] [max ticks] [seconds] [kilobytes] [--analytic] [--seed n]\n"
+        "       TapiocaHeadless bot [games] [max ticks] [--depth n] [--analytic] [--seed n] [--threads n]\n"
+        "       TapiocaHeadless profile [games] [max ticks] [trace file] [--depth n] [--seed n] [--threads n]\n"
+        "       TapiocaHeadless counters [games] [max ticks] [file] [--analytic] [--seed n] [--swept] [--egg-speed v]\n"
+        "       TapiocaHeadless allocations [games] [max ticks] [warm-up ticks] [--analytic] [--seed n]\n"
+        "       TapiocaHeadless sweep [games] [max ticks] [--analytic] [--seed n]\n"
+        "       TapiocaHeadless fixed [games] [max ticks] [--seed n] [--spawn-interval ticks] [--gravity g]\n"
+        "                       [--egg-speed v]\n"
+        "       TapiocaHeadless framerates [seconds] [--analytic] [--seed n]\n"
+        "       TapiocaHeadless record <file> [max ticks] [--analytic] [--seed n]\n"
+        "                       [--spawn-interval ticks] [--gravity g] [--egg-speed v] [--swept]\n"
+        "       TapiocaHeadless replay <file> [repeats]\n");
+}
+
+int main(int argc, char* argv[]) {
+    const char* command = "run";
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "-h") == 0 || std::strcmp(argv[i], "--help") == 0) {
+            printUsage();
+            return 0;
+        } else if (std::strcmp(argv[i], "--analytic") == 0) {
+            options.fallingMode = tapioca::FallingMode::Analytic;
+        } else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            options.seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            options.threads = static_cast<unsigned>(std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--spawn-interval") == 0 && i + 1 < argc) {
+            options.blockSpawnInterval = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--gravity") == 0 && i + 1 < argc) {
+            options.gravity = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--egg-speed") == 0 && i + 1 < argc) {
+            options.eggSpeed = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--swept") == 0) {
+            options.sweptCollision = true;
+        } else if (std::strcmp(argv[i], "--depth") == 0 && i + 1 < argc) {
+            options.depth = std::atoi(argv[++i]);
+        } else if (i == 1 && !std::isdigit(static_cast<unsigned char>(argv[i][0]))) {
+            command = argv[i];
+        } else {
+            options.args.push_back(argv[i]);
+        }
+    }
+
+    try {
+        if (std::strcmp(command, "run") == 0) {
+            return runGames(options);
+        }
+        if (std::strcmp(command, "stress") == 0) {
+            return runStress(options);
+        }
+        if (std::strcmp(command, "fastforward") == 0) {
+            return runFastForward(options);
+        }
+        if (std::strcmp(command, "framerates") == 0) {
+            return runFrameRates(options);
+        }
+        if (std::strcmp(command, "record") == 0) {
+            return runRecord(options);
+        }
+        if (std::strcmp(command, "replay") == 0) {
+            return runReplay(options);
+        }
+        if (std::strcmp(command, "vecenv") == 0) {
+            return runVectorEnv(options);
+        }
+        if (std::strcmp(command, "observe") == 0) {
+            return runObserve(options);
+        }
+        if (std::strcmp(command, "snapshot") == 0) {
+            return runSnapshot(options);
+        }
+        if (std::strcmp(command, "trajectory") == 0) {
+            return runTrajectory(options);
+        }
+        if (std::strcmp(command, "hash") == 0) {
+            return runHash(options);
+        }
+        if (std::strcmp(command, "rewind") == 0) {
+            return runRewind(options);
+        }
+        if (std::strcmp(command, "bot") == 0) {
+            return runBot(options);
+        }
+        if (std::strcmp(command, "fixed") == 0) {
+            return runFixed(options);
+        }
+        if (std::strcmp(command, "profile") == 0) {
+            return runProfile(options);
+        }
+        if (std::strcmp(command, "counters") == 0) {
+            return runCounters(options);
+        }
+        if (std::strcmp(command, "allocations") == 0) {
+            return runAllocations(options);
+        }
+        if (std::strcmp(command, "sweep") == 0) {
+            return runSweep(options);
+        }
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "error: %s\n", e.what());
+        return 1;
+    }
+    printUsage();
+    return 1;
+}
@@ -1,8 +1,25 @@
 ﻿#include "pch.h"
+#include <chrono>
+#include "Core/Bot.h"
+#include "Core/Clock.h"
+#include "Core/CountAllocations.h"
+#include "Core/CounterLog.h"
+#include "Core/Counters.h"
+#include "Core/EggFlight.h"
+#include "Core/FrameStats.h"
+#include "Core/Profiler.h"
+#include "Core/Replay.h"
+#include "Core/Rewind.h"
+#include "Core/World.h"
 
-constexpr double gravity = 1.5;
 constexpr double floorHeight = 80;
 constexpr int numBlocksX = 8;
+constexpr auto fallingMode = tapioca::FallingMode::Analytic;
+constexpr auto replayFile = "replay";
+// Written on F9 and on exit when built with TAPIOCA_PROFILE.
+constexpr auto traceFile = "trace.json";
+// Frames between two layouts of the performance overlay's text.
+constexpr int statsRefreshFrames = 30;
 
 enum class Scene {
     Title,
@@ -10,11 +27,13 @@ enum class Scene {
     GameOver
 };
 
+// Advances by simulation ticks rather than wall-clock time, so it stays in
+// step with the game at any frame rate.
 class Animation {
 public:
     Animation(std::vector<FilePath> textures, double intervals, bool looped = true, bool immediatelyStarted = true) :
         looped(looped),
-        timer(intervals) {
+        intervalTicks(tapioca::secondsToTicks(intervals)) {
         for (const auto& path : textures) {
             texAssets.emplace_back(path);
         }
@@ -24,26 +43,27 @@ public:
     }
 
     void start() {
-        timer.restart();
+        ticks = 0;
         started = true;
     }
 
     void stop() {
-        timer.pause();
         started = false;
     }
 
+    // Called once per simulation tick.
     void update() {
-        if (timer.reachedZero()) {
-            if (looped) {
-                idx = (idx + 1) % texAssets.size();
-                timer.restart();
-            } else if (idx < texAssets.size() - 1) {
-                ++idx;
-                timer.restart();
-            } else {
-                started = false;
-            }
+        if (!started || ++ticks < intervalTicks) {
+            return;
+        }
+        if (looped) {
+            idx = (idx + 1) % texAssets.size();
+            ticks = 0;
+        } else if (idx < texAssets.size() - 1) {
+            ++idx;
+            ticks = 0;
+        } else {
+            started = false;
         }
     }
 
@@ -52,7 +72,7 @@ public:
     }
 
     bool isFinished() const {
-        return !looped && idx == texAssets.size() - 1 && timer.reachedZero();
+        return !looped && idx == texAssets.size() - 1 && ticks >= intervalTicks;
     }
 
     bool isStarted() const {
@@ -62,7 +82,8 @@ public:
 private:
     bool looped;
     std::vector<TextureAsset> texAssets;
-    Timer timer;
+    int intervalTicks;
+    int ticks = 0;
     size_t idx = 0;
     bool started = false;
 };
@@ -75,10 +96,12 @@ public:
         sunAnim({ U"sun1", U"sun2" }, 0.5) {}
 
     void update() {
+        TAPIOCA_ZONE("Stage::update");
         sunAnim.update();
     }
 
     void draw() const {
+        TAPIOCA_ZONE("Stage::draw");
         floorRect.draw(Color(123, 58, 21));
         floorRect.top().draw(5.0, Palette::Black);
         sunRect(sunAnim.get()).draw();
@@ -89,293 +112,196 @@ private:
     Animation sunAnim;
 };
 
-class Block {
-public:
-    using HitCallback = std::function<void(double height)>;
-
-    static const double fallingSpeed;
-    static const double size;
+RectF toRectF(const tapioca::Rect& rect) {
+    return RectF(rect.x, rect.y, rect.w, rect.h);
+}
 
-    Block(double x) : rect(x, -size, size, size) {}
+tapioca::Board makeBoard() {
+    tapioca::Board board;
+    board.width = Window::Width();
+    board.height = Window::Height();
+    board.floorHeight = floorHeight;
+    board.numBlocksX = numBlocksX;
+    return board;
+}
 
-    void update(const std::vector<Block>& blocks) {
-        speed = fallingSpeed;
-        if (willCollide(blocks)) {
-            if (rect.y <= 0.0) {
-                touchingTop = true;
-            }
+tapioca::Input readInput(const Optional<detail::Gamepad_impl>& gamepad) {
+    tapioca::Input input;
+    input.throwEgg = KeyZ.pressed() || (gamepad && gamepad->buttons.at(0).pressed());
+    input.left = KeyLeft.pressed() || (gamepad && gamepad->povLeft.pressed());
+    input.right = KeyRight.pressed() || (gamepad && gamepad->povRight.pressed());
+    input.jump = KeyUp.pressed() || (gamepad && gamepad->buttons.at(1).pressed());
+    return input;
+}
 
-            moving = false;
-            speed = 0.0;
-        } else {
-            moving = true;
-            rect.y += speed;
+// Returns the value following name on the command line, e.g. "--seed 42".
+Optional<String> readArg(const String& name) {
+    for (int i = 1; i + 1 < __argc; ++i) {
+        if (__wargv && Unicode::FromWString(__wargv[i]) == name) {
+            return Unicode::FromWString(__wargv[i + 1]);
+        }
+        if (__argv && Unicode::Widen(__argv[i]) == name) {
+            return Unicode::Widen(__argv[i + 1]);
         }
     }
+    return none;
+}
 
-    void draw() const {
-        rect(TextureAsset(U"block")).draw();
-    }
-
-    bool intersects(RectF other) const {
-        return other.intersects(rect);
-    }
-
-    void destroy() {
-        destroyed = true;
-        hitCallback(1.0 - rect.y / Window::Height());
-    }
-
-    bool isDestroyed() const {
-        return destroyed;
-    }
-
-    bool isMoving() const {
-        return moving;
-    }
-
-    bool isTouchingTop() const {
-        return touchingTop;
-    }
-
-    void setHitCallback(HitCallback callback) {
-        hitCallback = callback;
-    }
+// Looks its textures up once, as every lookup by name makes a String.
+class WorldRenderer {
+public:
+    WorldRenderer() :
+        blockTex(U"block"),
+        eggTex(U"tamago"),
+        explosionTex{ { TextureAsset(U"boom1"), TextureAsset(U"boom2") } },
+        deathTex(U"death"),
+        throwingTex(U"throw1"),
+        restingAnim({ U"stop1", U"stop2" }, 0.3) {}
 
-    double getPosY() const {
-        return rect.y;
+    void update() {
+        restingAnim.update();
     }
 
-private:
-    RectF rect;
-    bool destroyed = false;
-    bool moving = true;
-    bool touchingTop = false;
-    double speed = 3.0;
-    HitCallback hitCallback;
-
-    bool willCollide(const std::vector<Block>& blocks) const {
-        if (rect.y + rect.h + speed > Window::Height() - floorHeight) {
-            return true;
-        }
-
-        auto nextRect = rect;
-        nextRect.y += speed;
-        for (const auto& block : blocks) {
-            if (this != &block && nextRect.intersects(block.rect)) {
-                return true;
-            }
+    void drawBlocks(const tapioca::World& world) const {
+        const auto& blocks = world.getBlocks();
+        for (int i = 0; i < blocks.size(); ++i) {
+            toRectF(blocks.getRect(i))(blockTex).draw();
         }
-        return false;
     }
-};
-
-const double Block::fallingSpeed = 3.0;
-const double Block::size = 50.0;
 
-class Egg {
-public:
-    Egg(Vec2 pos, bool right) :
-        rect(pos - Vec2(size / 2.0, size / 4.0), size, size),
-        velocity(right ? speed : -speed, -speed),
-        explosionAnim({ U"boom1", U"boom2" }, 0.1, false, false) {}
-
-    void update(std::vector<Block>& blocks) {
-        explosionAnim.update();
-
-        if (explosionAnim.isFinished()) {
-            destroyed = true;
-            return;
+    void drawPlayer(const tapioca::World& world) const {
+        const auto& player = world.getPlayer();
+        const auto rect = toRectF(player.getRect());
+        if (const auto& egg = player.getEgg()) {
+            const auto& tex = egg->isExploding() ? explosionTex.at(egg->getExplosionFrame()) : eggTex;
+            toRectF(egg->getRect())(tex).draw();
         }
-        if (explosionAnim.isStarted()) {
-            return;
+        if (player.isDead()) {
+            constexpr double armHeightInTexels = 30.0;
+            const auto tr = deathTex.scaled(rect.h / deathTex.height());
+            tr.drawAt(rect.bottomCenter() - Vec2(0.0, tr.size.y / 2.0 - armHeightInTexels * rect.h / deathTex.height()));
+        } else {
+            constexpr double heightInTexels = 315.0;
+            const auto& tex = player.isThrowing() ? throwingTex : restingAnim.get();
+            const auto tr = tex.mirrored(player.isFacingRight()).scaled(rect.h / heightInTexels);
+            tr.drawAt(rect.bottomCenter() - Vec2(0.0, tr.size.y / 2.0));
         }
+    }
 
-        if (rect.x + rect.w <= 0.0 || rect.x > Window::Width()) {
-            explosionAnim.start();
+    // Dots along the flight of an egg thrown now, up to the block it would hit.
+    void drawAim(const tapioca::World& world) const {
+        const auto& player = world.getPlayer();
+        if (player.isDead()) {
             return;
         }
-
-        for (auto& block : blocks) {
-            if (block.intersects(rect)) {
-                block.destroy();
-                explosionAnim.start();
-                return;
-            }
+        const auto& board = world.getBoard();
+        const bool right = player.isFacingRight();
+        const auto start = tapioca::Egg::getStartPos(player.getRect().topCenter());
+        const auto hit = tapioca::EggFlight::predict(world);
+        const int end = hit.block >= 0 ? hit.ticks : tapioca::EggFlight::getExitTick(start, right, board) - 1;
+        const auto center = tapioca::Vec2(tapioca::Egg::size / 2.0, tapioca::Egg::size / 2.0);
+        const auto color = player.getEggCooldown() > 0 ? ColorF(0.0, 0.2) : ColorF(0.0, 0.5);
+        for (int n = 0; n <= end; ++n) {
+            const auto pos = start + tapioca::EggFlight::getOffset(n, right, board) + center;
+            Circle(pos.x, pos.y, 3.0).draw(n == hit.ticks ? ColorF(Palette::Red) : color);
         }
-
-        velocity.y += gravity;
-        rect.pos += velocity;
-    }
-
-    void draw() const {
-        const auto& tex = explosionAnim.isStarted() ? explosionAnim.get() : TextureAsset(U"tamago");
-        rect(tex).draw();
-    }
-
-    bool isDestroyed() const {
-        return destroyed;
     }
 
 private:
-    static const double speed;
-    static const double size;
-    RectF rect;
-    Vec2 velocity;
-    bool destroyed = false;
-    Animation explosionAnim;
+    TextureAsset blockTex;
+    TextureAsset eggTex;
+    std::array<TextureAsset, 2> explosionTex;
+    TextureAsset deathTex;
+    TextureAsset throwingTex;
+    Animation restingAnim;
 };
 
-const double Egg::speed = 20.0;
-const double Egg::size = 50.0;
-
-class Player {
+// A label followed by a zero-padded score, formatted again only when the
+// score changes rather than every frame.
+class ScoreText {
 public:
-    Player(Optional<detail::Gamepad_impl> gp) :
-        gamepad(gp),
-        rect(100, Window::Height() - floorHeight - size.y, size),
-        eggLaunchTimer(0.5, false),
-        restingAnim({ U"stop1", U"stop2" }, 0.3),
-        throwingAnim({ U"throw1" }, 0.2, false, false) {
-        eggLaunchTimer.set(0s);
-    }
-
-    void update(std::vector<Block>& blocks) {
-        const bool keyThrow = KeyZ.pressed() || (gamepad && gamepad->buttons.at(0).pressed());
-        const bool keyLeft = KeyLeft.pressed() || (gamepad && gamepad->povLeft.pressed());
-        const bool keyRight = KeyRight.pressed() || (gamepad && gamepad->povRight.pressed());
-        const bool keyJump = KeyUp.pressed() || (gamepad && gamepad->buttons.at(1).pressed());
-
-        if (keyThrow && eggLaunchTimer.reachedZero()) {
-            throwingAnim.start();
-            egg = Egg(rect.topCenter(), facingRight);
-            eggLaunchTimer.restart();
-        }
-        if (egg) {
-            egg->update(blocks);
-            if (egg->isDestroyed()) {
-                egg = none;
-            }
-        }
-
-        if (keyLeft ^ keyRight) {
-            facingRight = keyRight;
-
-            const bool left = keyLeft && rect.x > 0.0;
-            const bool right = keyRight && rect.x + rect.w < Window::Width();
-            if (left ^ right) {
-                double vx = left ? -speed : speed;
-                auto nextRect = rect;
-                nextRect.x += vx;
-                for (const auto& block : blocks) {
-                    if (block.intersects(nextRect)) {
-                        vx = 0.0;
-                        break;
-                    }
-                }
-                rect.x += vx;
-            }
-        }
-
-        if (grounded && keyJump) {
-            constexpr double jumpSpeed = 20.0;
-            vy = -jumpSpeed;
-            grounded = false;
-        }
-
-        vy += gravity;
-        bool touching = false;
-        auto nextRect = rect;
-        nextRect.y += vy;
-        for (const auto& block : blocks) {
-            if (block.intersects(nextRect)) {
-                if (block.isMoving()) {
-                    if (vy > 0.0) {
-                        grounded = touching = true;
-                    }
-                    vy = Block::fallingSpeed;
-                } else {
-                    grounded = touching = true;
-                    vy = 0.0;
-                }
-                break;
-            }
-        }
-
-        if (!touching && rect.y + rect.h + vy > Window::Height() - floorHeight) {
-            grounded = true;
-            vy = 0.0;
-        }
-
-        rect.y += vy;
-
-        if (grounded) {
-            for (const auto& block : blocks) {
-                if (block.isMoving() && block.getPosY() < rect.y && block.intersects(rect)) {
-                    dead = true;
-                    break;
-                }
-            }
-        }
-
-        restingAnim.update();
-        throwingAnim.update();
-    }
+    explicit ScoreText(const String& label) : label(label) {}
 
-    void draw() const {
-        if (egg) {
-            egg->draw();
+    const DrawableText& get(const Font& font, int score) const {
+        if (!text || score != value) {
+            text = font(label, Pad(score, { 5, U'0' }));
+            value = score;
         }
-        if (dead) {
-            constexpr double armHeightInTexels = 30.0;
-            const auto tex = TextureAsset(U"death");
-            const auto tr = tex.scaled(rect.h / tex.height());
-            tr.drawAt(rect.bottomCenter() - Vec2(0.0, tr.size.y / 2.0 - armHeightInTexels * rect.h / tex.height()));
-        } else {
-            constexpr double heightInTexels = 315.0;
-            const auto& tex = (!throwingAnim.isStarted() || throwingAnim.isFinished()) ? restingAnim.get() : throwingAnim.get();
-            const auto tr = tex.mirrored(facingRight).scaled(rect.h / heightInTexels);
-            tr.drawAt(rect.bottomCenter() - Vec2(0.0, tr.size.y / 2.0));
-        }
-    }
-
-    bool isDead() const {
-        return dead;
+        return *text;
     }
 
 private:
-    static const Size size;
-    static const double speed;
-    Optional<detail::Gamepad_impl> gamepad;
-    double vy = 0.0;
-    RectF rect;
-    bool grounded = false;
-    bool facingRight = true;
-    bool dead = false;
-    Optional<Egg> egg;
-    Timer eggLaunchTimer;
-    Animation restingAnim, throwingAnim;
+    String label;
+    mutable Optional<DrawableText> text;
+    mutable int value = 0;
 };
 
-const Size Player::size = Size(40, 70);
-
-const double Player::speed = 8;
-
 struct Data {
     Font font = Font(28, U"PixelMplus10-Regular.ttf");
-    int score = 0;
     int highScore = 0;
+    ScoreText scoreText = ScoreText(U"SCORE ");
+    ScoreText highScoreText = ScoreText(U"HIGHSCORE ");
     Optional<detail::Gamepad_impl> gamepad;
+    // "--seed n" makes every game spawn the same blocks.
+    Optional<uint64> seed;
+    // "--replay file" plays a saved game instead of reading the controls.
+    Optional<tapioca::Replay> playback;
+    // "--bot depth" lets the computer play, looking depth choices ahead.
+    Optional<tapioca::Bot> bot;
+    // The game being played, saved to replayFile when it ends.
+    tapioca::Replay replay;
+    // A toggles the aim preview while playing.
+    bool showAim = false;
+    // F3 toggles the performance overlay.
+    bool showStats = false;
+    tapioca::FrameStats frameStats;
+    Font statsFont = Font(14, U"PixelMplus10-Regular.ttf");
+    Array<DrawableText> statsLines;
+    // "--counters file" saves the work done in every frame on exit, as JSON
+    // for a .json file and CSV otherwise.
+    Optional<std::string> counterFile;
+    tapioca::CounterLog counterLog;
+    // The last seconds of the game, scrubbed through on the game over screen.
+    tapioca::RewindBuffer rewind = tapioca::RewindBuffer(tapioca::secondsToTicks(10), 4 << 20);
     Stage stage;
-    Player player = Player(none);
-    std::vector<Block> blocks;
+    tapioca::FixedStepClock clock;
+    tapioca::World world = tapioca::World(makeBoard(), fallingMode);
+    WorldRenderer renderer;
 };
 
 using App = SceneManager<Scene, Data>;
 
 void drawScore(const Data& data) {
-    data.font(U"SCORE ", Pad(data.score, { 5, U'0' })).draw(Vec2::Zero(), Palette::Black);
-    data.font(U"HIGHSCORE ", Pad(data.highScore, { 5, U'0' })).draw(Arg::topRight = Vec2(Window::Width(), 0), Palette::Black);
+    data.scoreText.get(data.font, data.world.getScore()).draw(Vec2::Zero(), Palette::Black);
+    data.highScoreText.get(data.font, data.highScore).draw(Arg::topRight = Vec2(Window::Width(), 0), Palette::Black);
+}
+
+// Frame time percentiles and the work done per frame, over the last
+// FrameStats::window frames. Drawn by the main loop after the frame has
+// been measured, so that its own text does not show up in the numbers.
+// The text is laid out again every statsRefreshFrames frames.
+void drawStats(Data& data) {
+    if (!data.showStats) {
+        return;
+    }
+    auto& lines = data.statsLines;
+    if (lines.empty() || System::FrameCount() % statsRefreshFrames == 0) {
+        const auto& stats = data.frameStats;
+        const auto mean = stats.getMean();
+        const auto ms = [](double seconds) { return ToString(seconds * 1000.0, 2); };
+        lines.clear();
+        lines.push_back(data.statsFont(U"FRAME p50 ", ms(stats.getPercentile(0.5)), U" p95 ",
+            ms(stats.getPercentile(0.95)), U" p99 ", ms(stats.getPercentile(0.99)), U" ms"));
+        lines.push_back(data.statsFont(U"UPDATE ", ms(mean.updateSeconds), U" ms  DRAW ", ms(mean.drawSeconds), U" ms"));
+        lines.push_back(data.statsFont(U"BLOCKS ", data.world.getBlocks().size(), U"  TESTS ", mean.collisionTests,
+            U"  ALLOCS ", mean.allocations));
+    }
+    const double top = data.font.height();
+    const double lineHeight = data.statsFont.height();
+    RectF(0, top, Window::Width(), lineHeight * lines.size()).draw(ColorF(0.0, 0.6));
+    for (size_t i = 0; i < lines.size(); ++i) {
+        lines[i].draw(Vec2(4.0, top + i * lineHeight), Palette::White);
+    }
 }
 
 class Title : public App::Scene {
@@ -383,91 +309,117 @@ public:
     Title(const InitData& init) : IScene(init) {
         const auto tex = TextureAsset(U"title");
         titleTex = tex.scaled(static_cast<double>(Window::Width()) / tex.width());
+
+        Array<String> texts;
+        if (getData().gamepad.has_value()) {
+            texts = { U"← → うごく", U"B ジャンプ", U"A たまごをなげる", U"", U"Aをおして はじめる" };
+        } else {
+            texts = { U"← → うごく", U"↑ ジャンプ", U"Z たまごをなげる", U"", U"Zをおして はじめる" };
+        }
+        for (const auto& text : texts) {
+            lines.push_back(getData().font(text));
+        }
     }
 
     void update() override {
+        TAPIOCA_ZONE("Title::update");
         if (KeyZ.down() || (getData().gamepad.has_value() && getData().gamepad->buttons.at(0).down())) {
             changeScene(Scene::Playing, 0, false);
         }
     }
 
     void draw() const override {
+        TAPIOCA_ZONE("Title::draw");
         getData().stage.draw();
-        getData().player.draw();
+        getData().renderer.drawPlayer(getData().world);
         drawScore(getData());
         titleTex.drawAt(Window::Center() - Vec2(0.0, Window::Height() / 8.0));
 
         int i = 0;
-        std::vector<String> lines;
-        if (getData().gamepad.has_value()) {
-            lines = { U"← → うごく", U"B ジャンプ", U"A たまごをなげる", U"", U"Aをおして はじめる" };
-        } else {
-            lines = { U"← → うごく", U"↑ ジャンプ", U"Z たまごをなげる", U"", U"Zをおして はじめる" };
-        }
         for (const auto& line : lines) {
-            getData().font(line).drawAt(Window::Center() + Vec2(0.0, i++ * getData().font.height()), Palette::Black);
+            line.drawAt(Window::Center() + Vec2(0.0, i++ * getData().font.height()), Palette::Black);
         }
     }
 
 private:
     TextureRegion titleTex;
+    // The instructions, laid out once.
+    Array<DrawableText> lines;
 };
 
 class Playing : public App::Scene {
 public:
     Playing(const InitData& init) : IScene(init) {
-        getData().score = 0;
-        getData().player = Player(getData().gamepad);
-        getData().blocks = {};
-        blockFallSW.start();
+        if (const auto& playback = getData().playback) {
+            getData().world = playback->makeWorld();
+            cursor.emplace(*playback);
+        } else {
+            const auto seed = getData().seed ? *getData().seed : tapioca::Random::makeSeed();
+            getData().world = tapioca::World(makeBoard(), fallingMode, seed);
+            getData().replay = tapioca::Replay(getData().world);
+        }
+        if (getData().bot) {
+            getData().bot->reset();
+        }
+        getData().clock.reset();
+        getData().rewind.clear();
+        getData().rewind.record(getData().world);
     }
 
+    // Steps as many fixed ticks as real time has passed since the last
+    // frame, holding this frame's input for all of them.
     void update() override {
-        getData().stage.update();
-
-        auto& blocks = getData().blocks;
-        constexpr int blockFallIntervalms = 500;
-        if (blockFallSW.ms() > blockFallIntervalms) {
-            blocks.emplace_back(
-                Random(0, numBlocksX - 1) * Window::Width() /
-                static_cast<double>(numBlocksX));
-            blocks.back().setHitCallback([this](double height) {
-                getData().score += static_cast<int>(100.0 * height);
-                getData().highScore = std::max(getData().score, getData().highScore);
-            });
-            blockFallSW.restart();
-        }
-        for (auto& block : blocks) {
-            block.update(blocks);
-            if (block.isTouchingTop()) {
-                changeScene(Scene::GameOver, 0, false);
-                return;
+        TAPIOCA_ZONE("Playing::update");
+        auto& world = getData().world;
+        if (KeyA.down()) {
+            getData().showAim = !getData().showAim;
+        }
+        const auto input = readInput(getData().gamepad);
+        const int ticks = getData().clock.advance(System::DeltaTime());
+        for (int i = 0; i < ticks && !world.isGameOver() && !(cursor && cursor->atEnd()); ++i) {
+            getData().stage.update();
+            getData().renderer.update();
+            if (cursor) {
+                world.step(cursor->next());
+            } else {
+                const auto next = getData().bot ? getData().bot->decide(world) : input;
+                getData().replay.record(next);
+                world.step(next);
             }
+            getData().rewind.record(world);
         }
 
-        getData().player.update(getData().blocks);
-        if (getData().player.isDead()) {
-            changeScene(Scene::GameOver, 0, false);
+        if (cursor) {
+            if (world.isGameOver() || cursor->atEnd()) {
+                changeScene(Scene::GameOver, 0, false);
+            }
             return;
         }
-
-        blocks.erase(
-            std::remove_if(blocks.begin(), blocks.end(),
-                [](const auto& block) { return block.isDestroyed(); }),
-            blocks.end());
+        getData().highScore = std::max(world.getScore(), getData().highScore);
+        if (world.isGameOver()) {
+            getData().replay.finish(world);
+            try {
+                getData().replay.save(replayFile);
+            } catch (const std::runtime_error&) {
+                // Not being able to keep the replay is no reason to stop the game.
+            }
+            changeScene(Scene::GameOver, 0, false);
+        }
     }
 
     void draw() const override {
+        TAPIOCA_ZONE("Playing::draw");
         getData().stage.draw();
-        for (auto& block : getData().blocks) {
-            block.draw();
+        getData().renderer.drawBlocks(getData().world);
+        getData().renderer.drawPlayer(getData().world);
+        if (getData().showAim) {
+            getData().renderer.drawAim(getData().world);
         }
-        getData().player.draw();
         drawScore(getData());
     }
 
 private:
-    Stopwatch blockFallSW;
+    Optional<tapioca::Replay::Cursor> cursor;
 };
 
 class GameOver : public App::Scene {
@@ -475,38 +427,63 @@ public:
     GameOver(const InitData& init) : IScene(init) {
         const auto tex = TextureAsset(U"gameover");
         gameOverTex = tex.scaled(static_cast<double>(Window::Width()) / tex.width());
+        frame = getData().rewind.size() - 1;
     }
 
+    // Holding left or right steps back or forward through the recorded ticks.
     void update() override {
-        const auto gp = getData().gamepad;
+        TAPIOCA_ZONE("GameOver::update");
+        const auto& gp = getData().gamepad;
         if (KeyR.down() || (gp && gp->buttons.at(0).down())) {
             changeScene(Scene::Playing, 0, false);
+            return;
+        }
+
+        auto& rewind = getData().rewind;
+        if (rewind.size() == 0) {
+            return;
+        }
+        int next = frame;
+        if (KeyLeft.pressed() || (gp && gp->povLeft.pressed())) {
+            --next;
+        }
+        if (KeyRight.pressed() || (gp && gp->povRight.pressed())) {
+            ++next;
+        }
+        next = Clamp(next, 0, rewind.size() - 1);
+        if (next != frame) {
+            frame = next;
+            rewind.restore(frame, getData().world);
         }
     }
 
     void draw() const override {
+        TAPIOCA_ZONE("GameOver::draw");
         getData().stage.draw();
-        for (auto& block : getData().blocks) {
-            block.draw();
-        }
-        getData().player.draw();
+        getData().renderer.drawBlocks(getData().world);
+        getData().renderer.drawPlayer(getData().world);
         drawScore(getData());
         gameOverTex.drawAt(Window::Center() - Vec2(0.0, Window::Height() / 8.0));
 
         const auto button = getData().gamepad.has_value() ? U"A" : U"R";
         getData().font(button, U"をおして もういちどはじめる").drawAt(Window::Center() + Vec2(0.0, Window::Height() / 8.0), Palette::Black);
+        getData().font(U"SEED ", getData().world.getSeed()).draw(Arg::bottomLeft = Vec2(0, Window::Height()), Palette::White);
+
+        const auto& rewind = getData().rewind;
+        if (rewind.size() > 1) {
+            const auto back = rewind.getTick(rewind.size() - 1) - rewind.getTick(frame);
+            getData().font(U"← → REWIND -", ToString(back / static_cast<double>(tapioca::ticksPerSecond), 2), U"s")
+                .draw(Arg::bottomRight = Vec2(Window::Width(), Window::Height()), Palette::White);
+        }
     }
 
 private:
     TextureRegion gameOverTex;
+    int frame = 0;
 };
 
-void Main() {
-    Window::SetTitle(U"Tapioca");
-    Window::Resize({ static_cast<int>(Block::size * numBlocksX), 600 });
-    Graphics::SetTargetFrameRateHz(60);
-    Graphics::SetBackground(Color(212, 255, 252));
-
+void loadAssets() {
+    TAPIOCA_ZONE("loadAssets");
     TextureAsset::Register(U"block", U"imgs/block.png");
     TextureAsset::Register(U"boom1", U"imgs/boom1.png");
     TextureAsset::Register(U"boom2", U"imgs/boom2.png");
@@ -523,6 +500,14 @@ void Main() {
     AudioAsset::Register(U"bgm", U"tapiocamild.mp3");
     AudioAsset(U"bgm").setLoop(true);
     AudioAsset(U"bgm").play();
+}
+
+void Main() {
+    Window::SetTitle(U"Tapioca");
+    Window::Resize({ static_cast<int>(tapioca::Block::size * numBlocksX), 600 });
+    Graphics::SetBackground(Color(212, 255, 252));
+
+    loadAssets();
 
     const auto data = std::make_shared<Data>();
 
@@ -534,6 +519,23 @@ void Main() {
         }
     }
 
+    if (const auto seed = readArg(U"--seed")) {
+        data->seed = ParseOpt<uint64>(*seed);
+    }
+    if (const auto depth = readArg(U"--bot")) {
+        data->bot.emplace(ParseOr<int>(*depth, tapioca::Bot::defaultDepth), 0u);
+    }
+    if (const auto path = readArg(U"--counters")) {
+        data->counterFile = path->narrow();
+    }
+    if (const auto path = readArg(U"--replay")) {
+        try {
+            data->playback = tapioca::Replay::load(path->narrow());
+        } catch (const std::runtime_error&) {
+            // Fall back to a normal game.
+        }
+    }
+
     const auto pads = System::EnumerateGamepads();
     if (!pads.empty()) {
         data->gamepad = Gamepad(pads.front().index);
@@ -545,10 +547,48 @@ void Main() {
         .add<GameOver>(Scene::GameOver);
     mgr.changeScene(Scene::Title, 0, false);
 
+    using StatsClock = std::chrono::steady_clock;
+    auto lastFrame = StatsClock::now();
     while (System::Update()) {
-        if (!mgr.update()) {
+        if (KeyF3.down()) {
+            data->showStats = !data->showStats;
+            data->statsLines.clear();
+        }
+        const auto frameStart = StatsClock::now();
+        const auto counters = tapioca::threadCounters;
+        if (!mgr.updateScene()) {
             break;
         }
+        const auto updated = StatsClock::now();
+        mgr.drawScene();
+        const auto drawn = StatsClock::now();
+
+        tapioca::FrameStats::Frame frame;
+        frame.seconds = std::chrono::duration<double>(frameStart - lastFrame).count();
+        frame.updateSeconds = std::chrono::duration<double>(updated - frameStart).count();
+        frame.drawSeconds = std::chrono::duration<double>(drawn - updated).count();
+        const auto counts = tapioca::threadCounters - counters;
+        frame.collisionTests = counts.collisionTests;
+        frame.allocations = counts.allocations;
+        data->frameStats.add(frame);
+        if (data->counterFile) {
+            data->counterLog.add(System::FrameCount(), counts);
+        }
+        drawStats(*data);
+        lastFrame = frameStart;
+        if (tapioca::Profiler::enabled && KeyF9.down()) {
+            tapioca::Profiler::writeChromeTrace(traceFile);
+        }
+    }
+    if (tapioca::Profiler::enabled) {
+        tapioca::Profiler::writeChromeTrace(traceFile);
+    }
+    if (data->counterFile) {
+        try {
+            data->counterLog.save(*data->counterFile);
+        } catch (const std::runtime_error&) {
+            // Nothing to be done about it on the way out.
+        }
     }
 
     BinaryWriter writer(scoreFile);